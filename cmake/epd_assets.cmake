@@ -0,0 +1,88 @@
+#
+# Copyright 2026 8dcc
+#
+# This file is part of rp2350-epaper.
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+# Convert images into 'epd_image_t' variables at build time, using
+# 'tools/epd_asset.py'. Usage:
+#
+#   epd_add_assets(<target>
+#                  [ROTATE <degrees>]
+#                  [DITHER <threshold|bayer|floyd-steinberg|atkinson>]
+#                  [THRESHOLD <level>]
+#                  [INVERT]
+#                  [COMPRESS]
+#                  FILES <image>...)
+#
+# Each image is exported as 'asset_<name>', where <name> is the file name
+# without extension, and declared in the generated "asset_<name>.h" header.
+
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+set(EPD_ASSET_TOOL ${CMAKE_CURRENT_LIST_DIR}/../tools/epd_asset.py)
+set(EPD_ASSET_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/../src)
+
+function(epd_add_assets target)
+    cmake_parse_arguments(ARG
+        "INVERT;COMPRESS"
+        "ROTATE;DITHER;THRESHOLD"
+        "FILES"
+        ${ARGN}
+    )
+
+    set(options)
+    if(ARG_ROTATE)
+        list(APPEND options --rotate ${ARG_ROTATE})
+    endif()
+    if(ARG_DITHER)
+        list(APPEND options --dither ${ARG_DITHER})
+    endif()
+    if(ARG_THRESHOLD)
+        list(APPEND options --threshold ${ARG_THRESHOLD})
+    endif()
+    if(ARG_INVERT)
+        list(APPEND options --invert)
+    endif()
+    if(ARG_COMPRESS)
+        list(APPEND options --compress)
+    endif()
+
+    set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/epd_assets)
+    file(MAKE_DIRECTORY ${output_dir})
+
+    foreach(file ${ARG_FILES})
+        get_filename_component(input ${file} ABSOLUTE)
+        get_filename_component(stem ${file} NAME_WE)
+        string(MAKE_C_IDENTIFIER "asset_${stem}" name)
+
+        add_custom_command(
+            OUTPUT ${output_dir}/${name}.c ${output_dir}/${name}.h
+            COMMAND ${Python3_EXECUTABLE} ${EPD_ASSET_TOOL} ${input}
+                    --name ${name}
+                    ${options}
+                    --output ${output_dir}/${name}.c
+                    --header ${output_dir}/${name}.h
+            DEPENDS ${input} ${EPD_ASSET_TOOL}
+            COMMENT "Converting image asset ${file}"
+            VERBATIM
+        )
+        target_sources(${target} PRIVATE ${output_dir}/${name}.c)
+    endforeach()
+
+    target_include_directories(${target} PRIVATE
+        ${output_dir}
+        ${EPD_ASSET_SOURCE_DIR}
+    )
+endfunction()
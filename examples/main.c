@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
 
 #include "epaper_display.h"
 
@@ -39,6 +40,7 @@ static void demo_text(epd_ctx_t* ctx) {
     epd_draw_str(ctx, 10, 10, "Hello Pico 2 W", EPD_COLOR_BLACK);
     epd_draw_str(ctx, 10, 30, "WeAct 2.9\" EPD", EPD_COLOR_BLACK);
     epd_draw_str(ctx, 10, 50, "296x128 pixels", EPD_COLOR_BLACK);
+    epd_draw_str(ctx, 10, 70, "Temp.: 21°C", EPD_COLOR_BLACK);
     epd_flush(ctx);
     sleep_ms(3000);
 }
@@ -119,6 +121,9 @@ int main(void) {
         return 1;
     }
 
+    /* Sleep at a lower clock while the display refreshes */
+    epd_set_wait_mode(&display_ctx, EPD_WAIT_SLEEP, 48000);
+
     /* Clear display */
     printf("Clearing display...\n");
     epd_clear(&display_ctx, EPD_COLOR_WHITE);
@@ -145,11 +150,14 @@ int main(void) {
     sleep_ms(2000);
     epd_sleep(&display_ctx);
 
+    /* Print the latency of each drawing function, if profiling is enabled */
+    epd_profile_dump();
+
     printf("Done!\n");
 
-    /* Main loop (do nothing) */
+    /* Main loop (sleep until an interrupt, since there is nothing to do) */
     for (;;)
-        tight_loop_contents();
+        __wfi();
 
     return 0;
 }
@@ -87,27 +87,61 @@ static bool epd_init_spi(const epd_ctx_t* ctx) {
  */
 static bool epd_init_model_properties(epd_ctx_t* ctx) {
     switch (ctx->model) {
-        case EPD_MODEL_2IN9: {
+        case EPD_MODEL_2IN9:
+        case EPD_MODEL_2IN9_BWR: {
+            const bool red = (ctx->model == EPD_MODEL_2IN9_BWR);
+
             ctx->width  = 128;
             ctx->height = 296;
 
-            /* The monochrome display uses 1 bit per pixel, so we divide by 8 */
+            /*
+             * Each plane uses 1 bit per pixel, so we divide by 8. The red plane
+             * of the three-color display is allocated after the first one.
+             */
             ctx->framebuffer_size = ctx->width * ctx->height / 8;
-            ctx->framebuffer = malloc(ctx->framebuffer_size);
+            ctx->framebuffer = malloc(ctx->framebuffer_size * (red ? 2 : 1));
             if (ctx->framebuffer == NULL)
                 return false;
+            ctx->framebuffer_red =
+              red ? &ctx->framebuffer[ctx->framebuffer_size] : NULL;
+
+            ctx->row_hashes = malloc(ctx->height * sizeof(uint32_t));
+            if (ctx->row_hashes == NULL) {
+                free(ctx->framebuffer);
+                ctx->framebuffer     = NULL;
+                ctx->framebuffer_red = NULL;
+                return false;
+            }
 
-            ctx->display_funcs.init_display     = epd_2in9_init_display;
-            ctx->display_funcs.reset            = epd_2in9_reset;
-            ctx->display_funcs.flush            = epd_2in9_flush;
-            ctx->display_funcs.sleep            = epd_2in9_sleep;
+            ctx->display_funcs.init_step =
+              red ? epd_2in9_bwr_init_step : epd_2in9_init_step;
+            ctx->display_funcs.reset = epd_2in9_reset;
+            ctx->display_funcs.flush = red ? epd_2in9_bwr_flush : epd_2in9_flush;
+            ctx->display_funcs.sleep = epd_2in9_sleep;
+            ctx->display_funcs.load_frame =
+              red ? epd_2in9_bwr_load_frame : epd_2in9_load_frame;
             ctx->display_funcs.clear            = epd_2in9_clear;
+            ctx->display_funcs.scroll           = epd_2in9_scroll;
             ctx->display_funcs.draw_pixel       = epd_2in9_draw_pixel;
             ctx->display_funcs.draw_line        = epd_2in9_draw_line;
             ctx->display_funcs.draw_rect        = epd_2in9_draw_rect;
             ctx->display_funcs.draw_filled_rect = epd_2in9_draw_filled_rect;
-            ctx->display_funcs.draw_char        = epd_2in9_draw_char;
-            ctx->display_funcs.draw_str         = epd_2in9_draw_str;
+            ctx->display_funcs.draw_circle      = epd_2in9_draw_circle;
+            ctx->display_funcs.draw_filled_circle =
+              epd_2in9_draw_filled_circle;
+            ctx->display_funcs.draw_arc        = epd_2in9_draw_arc;
+            ctx->display_funcs.draw_round_rect = epd_2in9_draw_round_rect;
+            ctx->display_funcs.draw_filled_round_rect =
+              epd_2in9_draw_filled_round_rect;
+            ctx->display_funcs.draw_polygon = epd_2in9_draw_polygon;
+            ctx->display_funcs.draw_filled_polygon =
+              epd_2in9_draw_filled_polygon;
+            ctx->display_funcs.draw_bitmap = epd_2in9_draw_bitmap;
+            ctx->display_funcs.draw_bitmap_scaled =
+              epd_2in9_draw_bitmap_scaled;
+            ctx->display_funcs.copy_bitmap = epd_2in9_copy_bitmap;
+            ctx->display_funcs.draw_char   = epd_2in9_draw_char;
+            ctx->display_funcs.draw_str    = epd_2in9_draw_str;
         } break;
 
         default: {
@@ -119,11 +153,95 @@ static bool epd_init_model_properties(epd_ctx_t* ctx) {
     return true;
 }
 
+/*
+ * Compute the fingerprint of a framebuffer row. The row is hashed one 32-bit
+ * word at a time, so the cost of a flush that doesn't change anything is a few
+ * instructions per row.
+ */
+static uint32_t epd_hash_row(const uint8_t* row, size_t size) {
+    uint32_t hash = 0x811C9DC5;
+    size_t i      = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        uint32_t word;
+        memcpy(&word, &row[i], sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B1;
+        hash ^= hash >> 15;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ row[i]) * 0x01000193;
+
+    return hash;
+}
+
+/*
+ * Compute the fingerprint of a row of all the framebuffer planes.
+ */
+static uint32_t epd_row_fingerprint(const epd_ctx_t* ctx, size_t y) {
+    const size_t row_size = ctx->width / 8;
+
+    uint32_t hash = epd_hash_row(&ctx->framebuffer[y * row_size], row_size);
+    if (ctx->framebuffer_red != NULL)
+        hash ^= epd_hash_row(&ctx->framebuffer_red[y * row_size], row_size) *
+                0x85EBCA6B;
+
+    return hash;
+}
+
+/*
+ * Perform the next initialization step of the display model, and store the
+ * condition for performing the one after it.
+ */
+static void epd_init_next_step(epd_ctx_t* ctx) {
+    uint32_t delay_us = 0;
+    ctx->init_wait =
+      ctx->display_funcs.init_step(ctx, ctx->init_index++, &delay_us);
+    ctx->init_deadline = make_timeout_time_us(delay_us);
+}
+
+/*
+ * Save the current viewport in the stack of the context.
+ */
+static bool epd_save_viewport(epd_ctx_t* ctx) {
+    if (ctx->viewport_depth >= EPD_VIEWPORT_STACK_SIZE) {
+        EPD_LOG("Viewport stack is full (%d entries).", EPD_VIEWPORT_STACK_SIZE);
+        return false;
+    }
+
+    ctx->viewport_stack[ctx->viewport_depth++] = ctx->viewport;
+    return true;
+}
+
+/*
+ * Intersect the clip rectangle of the current viewport with the specified
+ * rectangle, in context coordinates.
+ */
+static void epd_intersect_clip(epd_ctx_t* ctx,
+                               int16_t x,
+                               int16_t y,
+                               uint16_t width,
+                               uint16_t height) {
+    epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t x0         = x + viewport->origin_x;
+    const int32_t y0         = y + viewport->origin_y;
+    const int32_t x1         = x0 + width;
+    const int32_t y1         = y0 + height;
+
+    if (x0 > viewport->clip_x0)
+        viewport->clip_x0 = (x0 < viewport->clip_x1) ? x0 : viewport->clip_x1;
+    if (y0 > viewport->clip_y0)
+        viewport->clip_y0 = (y0 < viewport->clip_y1) ? y0 : viewport->clip_y1;
+    if (x1 < viewport->clip_x1)
+        viewport->clip_x1 = (x1 > viewport->clip_x0) ? x1 : viewport->clip_x0;
+    if (y1 < viewport->clip_y1)
+        viewport->clip_y1 = (y1 > viewport->clip_y0) ? y1 : viewport->clip_y0;
+}
+
 /*----------------------------------------------------------------------------*/
 
-bool epd_init(epd_ctx_t* ctx,
-              const epd_pin_config_t* pin_config,
-              enum EEpdModels model) {
+bool epd_init_begin(epd_ctx_t* ctx,
+                    const epd_pin_config_t* pin_config,
+                    enum EEpdModels model) {
     /*
      * Copy the user pin configuration, and initialize the pins.
      */
@@ -139,11 +257,183 @@ bool epd_init(epd_ctx_t* ctx,
     if (!epd_init_model_properties(ctx))
         return false;
 
+    /* Use the built-in font until the user selects a different one */
+    ctx->font       = &font_5x7;
+    ctx->text_scale = EPD_SCALE_ONE;
+
+    /* Poll the display while it's busy, until the user selects a mode */
+    ctx->wait_mode      = EPD_WAIT_POLL;
+    ctx->wait_clock_khz = 0;
+    ctx->idle_hook      = NULL;
+    ctx->idle_hook_data = NULL;
+
+    /* Draw on the whole display, without translation */
+    ctx->viewport.origin_x  = 0;
+    ctx->viewport.origin_y  = 0;
+    ctx->viewport.clip_x0   = 0;
+    ctx->viewport.clip_y0   = 0;
+    ctx->viewport.clip_x1   = ctx->width;
+    ctx->viewport.clip_y1   = ctx->height;
+    ctx->viewport_depth     = 0;
+    ctx->viewport_low_depth = 0;
+
+    /* Nothing has been sent to the display yet */
+    epd_invalidate(ctx);
+
+    /* Start profiling from the initialization, if enabled */
+    epd_profile_reset();
+
+    /* Start with a white framebuffer, without red pixels */
+    memset(ctx->framebuffer, 0xFF, ctx->framebuffer_size);
+    if (ctx->framebuffer_red != NULL)
+        memset(ctx->framebuffer_red, 0x00, ctx->framebuffer_size);
+
+    /*
+     * Perform the first initialization step of the specific display model.
+     * The rest are performed by 'epd_poll'.
+     */
+    ctx->init_index = 0;
+    epd_init_next_step(ctx);
+
+    return true;
+}
+
+bool epd_init(epd_ctx_t* ctx,
+              const epd_pin_config_t* pin_config,
+              enum EEpdModels model) {
+    if (!epd_init_begin(ctx, pin_config, model))
+        return false;
+
+    while (ctx->init_wait != EPD_INIT_DONE) {
+        sleep_until(ctx->init_deadline);
+        if (ctx->init_wait == EPD_INIT_WAIT_BUSY)
+            epd_utils_wait_until_idle(ctx);
+        epd_init_next_step(ctx);
+    }
+
+    return true;
+}
+
+bool epd_poll(epd_ctx_t* ctx) {
+    /* Steps without delay are performed in the same call */
+    while (ctx->init_wait != EPD_INIT_DONE) {
+        if (!time_reached(ctx->init_deadline))
+            return false;
+        if (ctx->init_wait == EPD_INIT_WAIT_BUSY &&
+            gpio_get(ctx->pins.busy) == 1)
+            return false;
+
+        epd_init_next_step(ctx);
+    }
+
+    return true;
+}
+
+bool epd_push_clip(epd_ctx_t* ctx,
+                   int16_t x,
+                   int16_t y,
+                   uint16_t width,
+                   uint16_t height) {
+    if (!epd_save_viewport(ctx))
+        return false;
+
+    epd_intersect_clip(ctx, x, y, width, height);
+    return true;
+}
+
+bool epd_push_viewport(epd_ctx_t* ctx,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height) {
+    if (!epd_save_viewport(ctx))
+        return false;
+
+    epd_intersect_clip(ctx, x, y, width, height);
+    ctx->viewport.origin_x += x;
+    ctx->viewport.origin_y += y;
+    return true;
+}
+
+void epd_pop_viewport(epd_ctx_t* ctx) {
+    if (ctx->viewport_depth == 0) {
+        EPD_LOG("Viewport stack is empty.");
+        return;
+    }
+
+    ctx->viewport = ctx->viewport_stack[--ctx->viewport_depth];
+    if (ctx->viewport_depth < ctx->viewport_low_depth)
+        ctx->viewport_low_depth = ctx->viewport_depth;
+}
+
+bool epd_flush(epd_ctx_t* ctx) {
+    return epd_flush_rows(ctx, 0, ctx->height);
+}
+
+bool epd_flush_rows(epd_ctx_t* ctx, uint16_t y_start, uint16_t y_end) {
+    if (ctx->init_wait != EPD_INIT_DONE) {
+        EPD_LOG("Can't flush before the display is initialized.");
+        return false;
+    }
+
+    EPD_PROFILE_BEGIN();
+
     /*
-     * Initialize the specific display model.
+     * If the displayed content is unknown, every row has to be checked, since
+     * the fingerprints of the other rows would not be updated.
      */
-    if (!ctx->display_funcs.init_display(ctx))
+    if (!ctx->row_hashes_valid) {
+        y_start = 0;
+        y_end   = ctx->height;
+    } else if (y_end > ctx->height) {
+        y_end = ctx->height;
+    }
+
+    /*
+     * Find the first and last rows whose fingerprint changed, updating the
+     * stored fingerprints.
+     */
+    size_t changed_start = y_end;
+    size_t changed_end   = 0;
+    for (size_t y = y_start; y < y_end; y++) {
+        const uint32_t hash = epd_row_fingerprint(ctx, y);
+        if (ctx->row_hashes_valid && hash == ctx->row_hashes[y])
+            continue;
+
+        ctx->row_hashes[y] = hash;
+        if (y < changed_start)
+            changed_start = y;
+        changed_end = y + 1;
+    }
+    ctx->row_hashes_valid = true;
+
+    if (changed_start >= changed_end) {
+        EPD_PROFILE_END(EPD_PROF_FLUSH);
         return false;
+    }
 
+    ctx->changed_y0 = changed_start;
+    ctx->changed_y1 = changed_end;
+    ctx->display_funcs.flush(ctx, changed_start, changed_end);
+    EPD_PROFILE_END(EPD_PROF_FLUSH);
     return true;
 }
+
+void epd_get_changed_rows(const epd_ctx_t* ctx,
+                          uint16_t* y_start,
+                          uint16_t* y_end) {
+    *y_start = ctx->changed_y0;
+    *y_end   = ctx->changed_y1;
+}
+
+void epd_assume_displayed(epd_ctx_t* ctx) {
+    for (size_t y = 0; y < ctx->height; y++)
+        ctx->row_hashes[y] = epd_row_fingerprint(ctx, y);
+    ctx->row_hashes_valid = true;
+}
+
+void epd_invalidate(epd_ctx_t* ctx) {
+    ctx->row_hashes_valid = false;
+    ctx->changed_y0       = 0;
+    ctx->changed_y1       = 0;
+}
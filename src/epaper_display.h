@@ -23,12 +23,29 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "pico/time.h"
+
+#include "font.h"
+#include "epaper_display_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*
- * Color definitions for an E-Paper Display.
+ * Color definitions for an E-Paper Display. Drawing with EPD_COLOR_INVERT
+ * toggles the pixels instead of setting them, so drawing the same thing twice
+ * restores the original content. Drawing functions never draw a pixel twice,
+ * except where the outline of a polygon crosses itself.
+ *
+ * EPD_COLOR_RED can only be used with three-color models. In those, inverting
+ * only toggles between black and white, so red pixels are not modified.
  */
 enum EEpdColors {
     EPD_COLOR_BLACK,
     EPD_COLOR_WHITE,
+    EPD_COLOR_INVERT,
+    EPD_COLOR_RED,
 };
 
 /*
@@ -36,14 +53,62 @@ enum EEpdColors {
  */
 enum EEpdModels {
     EPD_MODEL_2IN9,
+    EPD_MODEL_2IN9_BWR, /* Three-color (black, white and red) variant */
 };
 
+/*
+ * Condition that must be met before performing the next initialization step of
+ * a display. See 'epd_init_begin'.
+ */
+enum EEpdInitWait {
+    EPD_INIT_WAIT_TIME, /* Wait until the deadline */
+    EPD_INIT_WAIT_BUSY, /* Wait until the deadline, then until idle */
+    EPD_INIT_DONE,      /* The display is initialized */
+};
+
+/*
+ * How the core waits while the display is busy refreshing. See
+ * 'epd_set_wait_mode'.
+ */
+enum EEpdWaitModes {
+    EPD_WAIT_POLL,  /* Check the BUSY pin every millisecond */
+    EPD_WAIT_SLEEP, /* Sleep the core until the BUSY pin interrupt */
+};
+
+/*
+ * Maximum number of nested 'epd_push_clip' and 'epd_push_viewport' calls.
+ */
+#define EPD_VIEWPORT_STACK_SIZE 8
+
+/*
+ * Maximum number of points in a filled polygon.
+ */
+#define EPD_POLYGON_MAX_POINTS 32
+
+/*
+ * Scale factors are fixed-point numbers with 8 fractional bits, so
+ * EPD_SCALE_ONE keeps the original size, 'EPD_SCALE(3)' triples it, and
+ * 'EPD_SCALE_ONE * 3 / 2' is 1.5 times it.
+ */
+#define EPD_SCALE_SHIFT 8
+#define EPD_SCALE_ONE   (1 << EPD_SCALE_SHIFT)
+#define EPD_SCALE(N)    ((N) << EPD_SCALE_SHIFT)
+
 /*----------------------------------------------------------------------------*/
 
 typedef struct epd_pin_config epd_pin_config_t;
 typedef struct epd_display_funcs epd_display_funcs_t;
+typedef struct epd_point epd_point_t;
+typedef struct epd_viewport epd_viewport_t;
 typedef struct epd_ctx epd_ctx_t;
 
+/*
+ * Function called while waiting for the display, before the core sleeps.
+ * Returns true if it has more work to do, so it's called again instead of
+ * sleeping.
+ */
+typedef bool (*epd_idle_hook_t)(void* data);
+
 /*
  * Structure containing the pins of the display.
  */
@@ -56,20 +121,36 @@ struct epd_pin_config {
     uint8_t busy;
 };
 
+/*
+ * Structure containing a point in context coordinates, used for polygons.
+ */
+struct epd_point {
+    int16_t x, y;
+};
+
 /*
  * Structure containing all model-specific functions for an E-Paper Display.
  */
 struct epd_display_funcs {
-    /* Initialization functions */
-    bool (*init_display)(const epd_ctx_t* ctx);
+    /*
+     * Initialization functions. The 'init_step' function performs the
+     * specified step of the initialization sequence, and returns the condition
+     * for performing the next one, which can't start until 'delay_us'
+     * microseconds have passed.
+     */
+    enum EEpdInitWait (*init_step)(const epd_ctx_t* ctx,
+                                   uint8_t step,
+                                   uint32_t* delay_us);
 
     /* Control functions */
     void (*reset)(const epd_ctx_t* ctx);
-    void (*flush)(const epd_ctx_t* ctx);
+    void (*flush)(const epd_ctx_t* ctx, uint16_t y_start, uint16_t y_end);
     void (*sleep)(const epd_ctx_t* ctx);
+    void (*load_frame)(const epd_ctx_t* ctx);
 
     /* Drawing functions */
     void (*clear)(const epd_ctx_t* ctx, uint8_t color);
+    void (*scroll)(const epd_ctx_t* ctx, int16_t dx, int16_t dy, uint8_t color);
     void (*draw_pixel)(const epd_ctx_t* ctx,
                        uint16_t x,
                        uint16_t y,
@@ -92,10 +173,74 @@ struct epd_display_funcs {
                              uint16_t width,
                              uint16_t height,
                              uint8_t color);
+    void (*draw_circle)(const epd_ctx_t* ctx,
+                        uint16_t x,
+                        uint16_t y,
+                        uint16_t radius,
+                        uint8_t color);
+    void (*draw_filled_circle)(const epd_ctx_t* ctx,
+                               uint16_t x,
+                               uint16_t y,
+                               uint16_t radius,
+                               uint8_t color);
+    void (*draw_arc)(const epd_ctx_t* ctx,
+                     uint16_t x,
+                     uint16_t y,
+                     uint16_t radius,
+                     int16_t start_angle,
+                     int16_t end_angle,
+                     uint8_t color);
+    void (*draw_round_rect)(const epd_ctx_t* ctx,
+                            uint16_t x,
+                            uint16_t y,
+                            uint16_t width,
+                            uint16_t height,
+                            uint16_t radius,
+                            uint8_t color);
+    void (*draw_filled_round_rect)(const epd_ctx_t* ctx,
+                                   uint16_t x,
+                                   uint16_t y,
+                                   uint16_t width,
+                                   uint16_t height,
+                                   uint16_t radius,
+                                   uint8_t color);
+    void (*draw_polygon)(const epd_ctx_t* ctx,
+                         const epd_point_t* points,
+                         size_t count,
+                         uint8_t color);
+    void (*draw_filled_polygon)(const epd_ctx_t* ctx,
+                                const epd_point_t* points,
+                                size_t count,
+                                uint8_t color);
+    void (*draw_bitmap)(const epd_ctx_t* ctx,
+                        uint16_t x,
+                        uint16_t y,
+                        uint16_t width,
+                        uint16_t height,
+                        const uint8_t* bitmap,
+                        size_t stride,
+                        uint8_t color);
+    void (*draw_bitmap_scaled)(const epd_ctx_t* ctx,
+                               uint16_t x,
+                               uint16_t y,
+                               uint16_t width,
+                               uint16_t height,
+                               const uint8_t* bitmap,
+                               size_t stride,
+                               uint16_t scale_x,
+                               uint16_t scale_y,
+                               uint8_t color);
+    void (*copy_bitmap)(const epd_ctx_t* ctx,
+                        uint16_t x,
+                        uint16_t y,
+                        uint16_t width,
+                        uint16_t height,
+                        const uint8_t* bitmap,
+                        size_t stride);
     void (*draw_char)(const epd_ctx_t* ctx,
                       uint16_t x,
                       uint16_t y,
-                      char c,
+                      uint32_t codepoint,
                       uint8_t color);
     void (*draw_str)(const epd_ctx_t* ctx,
                      uint16_t x,
@@ -104,6 +249,21 @@ struct epd_display_funcs {
                      uint8_t color);
 };
 
+/*
+ * Structure containing the translation and clipping applied to all drawing
+ * functions.
+ *
+ * The origin is added to the coordinates received by the drawing functions.
+ * The clip rectangle is in display coordinates, and it's always inside of the
+ * display; its end coordinates are exclusive. Pixels outside of it are never
+ * drawn.
+ */
+struct epd_viewport {
+    int16_t origin_x, origin_y;
+    int16_t clip_x0, clip_y0;
+    int16_t clip_x1, clip_y1;
+};
+
 /*
  * Structure containing all context information for drawing in an E-Paper
  * Display.
@@ -130,6 +290,72 @@ struct epd_ctx {
     /* Size of the allocated framebuffer, in bytes */
     size_t framebuffer_size;
 
+    /*
+     * Second plane of three-color models, with the same layout and size as
+     * 'framebuffer'. Set bits are red, independently of the value of the first
+     * plane. Allocated in 'epd_init' right after 'framebuffer', in the same
+     * block, and NULL for monochrome models.
+     */
+    uint8_t* framebuffer_red;
+
+    /*
+     * Fingerprint of each framebuffer row, as it was last sent to the display.
+     * Allocated in 'epd_init' with one entry per row, and used by 'epd_flush'
+     * for skipping rows (or whole refreshes) whose content didn't change. The
+     * fingerprints are only meaningful if 'row_hashes_valid' is true.
+     */
+    uint32_t* row_hashes;
+    bool row_hashes_valid;
+
+    /* Range of rows [changed_y0, changed_y1) sent by the last 'epd_flush' */
+    uint16_t changed_y0, changed_y1;
+
+    /*
+     * State of the display initialization: next step to perform, condition
+     * for performing it, and the earliest time at which it can be performed.
+     */
+    uint8_t init_index;
+    enum EEpdInitWait init_wait;
+    absolute_time_t init_deadline;
+
+    /*
+     * How to wait while the display is busy, the system clock frequency (in
+     * kHz) while waiting, or zero for keeping it, and the function called
+     * while waiting. See 'epd_set_wait_mode' and 'epd_set_idle_hook'.
+     */
+    enum EEpdWaitModes wait_mode;
+    uint32_t wait_clock_khz;
+    epd_idle_hook_t idle_hook;
+    void* idle_hook_data;
+
+    /*
+     * Font used by the text drawing functions. Initialized to the built-in
+     * font in 'epd_init', and can be changed with 'epd_set_font'.
+     */
+    const epd_font_t* font;
+
+    /*
+     * Scale of the text drawing functions, in the format of EPD_SCALE_ONE.
+     * Initialized to EPD_SCALE_ONE in 'epd_init', and can be changed with
+     * 'epd_set_text_scale'.
+     */
+    uint16_t text_scale;
+
+    /*
+     * Current translation and clip rectangle, and the ones saved by the
+     * 'epd_push_*' functions. Initialized to the whole display in 'epd_init'.
+     */
+    epd_viewport_t viewport;
+    epd_viewport_t viewport_stack[EPD_VIEWPORT_STACK_SIZE];
+    size_t viewport_depth;
+
+    /*
+     * Lowest 'viewport_depth' reached by 'epd_pop_viewport' since it was last
+     * set to the current depth. Since pushing only shrinks the clip rectangle,
+     * the widest one that was active since then is the one at this depth.
+     */
+    size_t viewport_low_depth;
+
     /*
      * List of functions that affect this specific model. Assigned in
      * 'epd_init', depending on the selected model.
@@ -141,40 +367,153 @@ struct epd_ctx {
 
 /*
  * Initialize an E-Paper Display context with the specific SPI pin
- * configuration, and the specific board model.
+ * configuration, and the specific board model. Blocks until the display is
+ * initialized.
  */
 bool epd_init(epd_ctx_t* ctx,
               const epd_pin_config_t* pin_config,
               enum EEpdModels model);
 
+/*
+ * Start initializing an E-Paper Display context, like 'epd_init', but without
+ * blocking. The context can be drawn to as soon as this function returns, but
+ * the display can't be flushed until 'epd_poll' returns true.
+ */
+bool epd_init_begin(epd_ctx_t* ctx,
+                    const epd_pin_config_t* pin_config,
+                    enum EEpdModels model);
+
+/*
+ * Perform the initialization steps of the display that are ready, without
+ * blocking. Should be called periodically after 'epd_init_begin'. Returns true
+ * once the display is initialized.
+ */
+bool epd_poll(epd_ctx_t* ctx);
+
+/*
+ * Save the current viewport, and intersect the clip rectangle with the
+ * specified rectangle, in context coordinates. Returns false if the viewport
+ * stack is full.
+ */
+bool epd_push_clip(epd_ctx_t* ctx,
+                   int16_t x,
+                   int16_t y,
+                   uint16_t width,
+                   uint16_t height);
+
+/*
+ * Save the current viewport, and start a nested viewport for the specified
+ * rectangle, in context coordinates. The clip rectangle is intersected with it,
+ * and the origin is moved to its top-left corner, so drawing functions can be
+ * called with local coordinates. Returns false if the viewport stack is full.
+ */
+bool epd_push_viewport(epd_ctx_t* ctx,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height);
+
+/*
+ * Restore the viewport saved by the last 'epd_push_clip' or 'epd_push_viewport'
+ * call.
+ */
+void epd_pop_viewport(epd_ctx_t* ctx);
+
 /*
  * Reset the display
  */
 static inline void epd_reset(const epd_ctx_t* ctx) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.reset(ctx);
+    EPD_PROFILE_END(EPD_PROF_RESET);
 }
 
 /*
- * Update the display with current framebuffer content
+ * Update the display with current framebuffer content. Only the rows that
+ * changed since the last flush are sent to the display, and if no row changed,
+ * the display is not refreshed at all. Returns true if the display was
+ * refreshed, and false if nothing changed or the display is not initialized.
+ */
+bool epd_flush(epd_ctx_t* ctx);
+
+/*
+ * Update the display like 'epd_flush', but only with the rows [y_start, y_end)
+ * that changed, in display coordinates. Changes outside of them are sent by a
+ * later flush. If the content of the display is unknown (see
+ * 'epd_invalidate'), all rows are sent.
+ */
+bool epd_flush_rows(epd_ctx_t* ctx, uint16_t y_start, uint16_t y_end);
+
+/*
+ * Get the range of rows [y_start, y_end) that were sent to the display by the
+ * last 'epd_flush' call that refreshed it, in display coordinates.
+ */
+void epd_get_changed_rows(const epd_ctx_t* ctx,
+                          uint16_t* y_start,
+                          uint16_t* y_end);
+
+/*
+ * Forget the content that was last sent to the display, so the next
+ * 'epd_flush' call sends the whole framebuffer. Must be called if the memory
+ * of the display was lost, for example after a hardware reset.
+ */
+void epd_invalidate(epd_ctx_t* ctx);
+
+/*
+ * Assume that the display already shows the current framebuffer content, so
+ * the next 'epd_flush' call only sends the rows that change after this call.
+ */
+void epd_assume_displayed(epd_ctx_t* ctx);
+
+/*
+ * Write the whole framebuffer to the memory of the display, as both the current
+ * and the previous image (or as the two planes of three-color models), without
+ * refreshing it. Used for restoring the memory of a display that still shows
+ * the framebuffer content.
  */
-static inline void epd_flush(const epd_ctx_t* ctx) {
-    ctx->display_funcs.flush(ctx);
+static inline void epd_load_frame(const epd_ctx_t* ctx) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.load_frame(ctx);
+    EPD_PROFILE_END(EPD_PROF_LOAD_FRAME);
 }
 
 /*
  * Put display into deep sleep mode
  */
 static inline void epd_sleep(const epd_ctx_t* ctx) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.sleep(ctx);
+    EPD_PROFILE_END(EPD_PROF_SLEEP);
 }
 
 /*
- * Clear the display to specified color
+ * Clear the display to specified color. The whole display is cleared,
+ * independently of the clip rectangle.
  *
  * FIXME: Use 'enum EEpdColors' instead of 'uint8_t'.
  */
 static inline void epd_clear(const epd_ctx_t* ctx, uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.clear(ctx, color);
+    EPD_PROFILE_END(EPD_PROF_CLEAR);
+}
+
+/*
+ * Move the content of the clip rectangle 'dx' pixels to the right and 'dy'
+ * pixels down (negative values move it left and up). The content moved outside
+ * of the clip rectangle is lost, and the exposed rows and columns are filled
+ * with the specified color (which can't be EPD_COLOR_INVERT), so only they
+ * have to be drawn again.
+ *
+ * Vertical scrolls of the whole display width are a single 'memmove'.
+ */
+static inline void epd_scroll(const epd_ctx_t* ctx,
+                              int16_t dx,
+                              int16_t dy,
+                              uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.scroll(ctx, dx, dy, color);
+    EPD_PROFILE_END(EPD_PROF_SCROLL);
 }
 
 /*
@@ -184,7 +523,9 @@ static inline void epd_draw_pixel(const epd_ctx_t* ctx,
                                   uint16_t x,
                                   uint16_t y,
                                   uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.draw_pixel(ctx, x, y, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_PIXEL);
 }
 
 /*
@@ -196,7 +537,9 @@ static inline void epd_draw_line(const epd_ctx_t* ctx,
                                  uint16_t x1,
                                  uint16_t y1,
                                  uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.draw_line(ctx, x0, y0, x1, y1, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_LINE);
 }
 
 /*
@@ -208,7 +551,9 @@ static inline void epd_draw_rect(const epd_ctx_t* ctx,
                                  uint16_t width,
                                  uint16_t height,
                                  uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.draw_rect(ctx, x, y, width, height, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_RECT);
 }
 
 /*
@@ -220,29 +565,283 @@ static inline void epd_draw_filled_rect(const epd_ctx_t* ctx,
                                         uint16_t width,
                                         uint16_t height,
                                         uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.draw_filled_rect(ctx, x, y, width, height, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_FILLED_RECT);
+}
+
+/*
+ * Draw the outline of a circle centered at (x, y)
+ */
+static inline void epd_draw_circle(const epd_ctx_t* ctx,
+                                   uint16_t x,
+                                   uint16_t y,
+                                   uint16_t radius,
+                                   uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_circle(ctx, x, y, radius, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_CIRCLE);
+}
+
+/*
+ * Draw a filled circle centered at (x, y)
+ */
+static inline void epd_draw_filled_circle(const epd_ctx_t* ctx,
+                                          uint16_t x,
+                                          uint16_t y,
+                                          uint16_t radius,
+                                          uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_filled_circle(ctx, x, y, radius, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_FILLED_CIRCLE);
+}
+
+/*
+ * Draw the part of a circle outline between two angles, in degrees. Angles
+ * start at the right of the center, and increase clockwise. Nothing is drawn
+ * if both angles are the same (modulo 360), and the whole circle is drawn if
+ * 'end_angle' is at least 360 degrees after 'start_angle'.
+ */
+static inline void epd_draw_arc(const epd_ctx_t* ctx,
+                                uint16_t x,
+                                uint16_t y,
+                                uint16_t radius,
+                                int16_t start_angle,
+                                int16_t end_angle,
+                                uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_arc(ctx,
+                                x,
+                                y,
+                                radius,
+                                start_angle,
+                                end_angle,
+                                color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_ARC);
+}
+
+/*
+ * Draw a rectangle with rounded corners
+ */
+static inline void epd_draw_round_rect(const epd_ctx_t* ctx,
+                                       uint16_t x,
+                                       uint16_t y,
+                                       uint16_t width,
+                                       uint16_t height,
+                                       uint16_t radius,
+                                       uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_round_rect(ctx, x, y, width, height, radius, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_ROUND_RECT);
+}
+
+/*
+ * Draw a filled rectangle with rounded corners
+ */
+static inline void epd_draw_filled_round_rect(const epd_ctx_t* ctx,
+                                              uint16_t x,
+                                              uint16_t y,
+                                              uint16_t width,
+                                              uint16_t height,
+                                              uint16_t radius,
+                                              uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_filled_round_rect(ctx,
+                                              x,
+                                              y,
+                                              width,
+                                              height,
+                                              radius,
+                                              color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_FILLED_ROUND_RECT);
+}
+
+/*
+ * Draw the outline of a closed polygon
+ */
+static inline void epd_draw_polygon(const epd_ctx_t* ctx,
+                                    const epd_point_t* points,
+                                    size_t count,
+                                    uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_polygon(ctx, points, count, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_POLYGON);
+}
+
+/*
+ * Draw a filled polygon, which can be concave or self-intersecting (using the
+ * even-odd rule). The points are placed at the top-left corner of their
+ * pixels, so a square from (0, 0) to (8, 8) fills 8x8 pixels. The polygon can
+ * have up to EPD_POLYGON_MAX_POINTS points.
+ */
+static inline void epd_draw_filled_polygon(const epd_ctx_t* ctx,
+                                           const epd_point_t* points,
+                                           size_t count,
+                                           uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_filled_polygon(ctx, points, count, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_FILLED_POLYGON);
 }
 
 /*
- * Draw a character at (x, y)
+ * Draw a 1bpp bitmap at (x, y). Each row of the bitmap starts 'stride' bytes
+ * after the previous one, and the leftmost pixel of a row is stored in the most
+ * significant bit of its first byte. Set bits are drawn with the specified
+ * color, and clear bits are left untouched.
+ */
+static inline void epd_draw_bitmap(const epd_ctx_t* ctx,
+                                   uint16_t x,
+                                   uint16_t y,
+                                   uint16_t width,
+                                   uint16_t height,
+                                   const uint8_t* bitmap,
+                                   size_t stride,
+                                   uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_bitmap(ctx,
+                                   x,
+                                   y,
+                                   width,
+                                   height,
+                                   bitmap,
+                                   stride,
+                                   color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_BITMAP);
+}
+
+/*
+ * Draw a 1bpp bitmap at (x, y) like 'epd_draw_bitmap', but scaled by the
+ * specified horizontal and vertical factors (see EPD_SCALE_ONE), with
+ * nearest-neighbor sampling. The 'width' and 'height' are the ones of the
+ * source bitmap, and the scaled size is rounded up, like in 'epd_scale_length'.
+ *
+ * Each source row is drawn once for all the rows that repeat it, and integer
+ * horizontal factors up to 8 expand each row through a lookup table, so the
+ * bitmap is drawn almost as fast as an unscaled one of the scaled size.
+ */
+static inline void epd_draw_bitmap_scaled(const epd_ctx_t* ctx,
+                                          uint16_t x,
+                                          uint16_t y,
+                                          uint16_t width,
+                                          uint16_t height,
+                                          const uint8_t* bitmap,
+                                          size_t stride,
+                                          uint16_t scale_x,
+                                          uint16_t scale_y,
+                                          uint8_t color) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_bitmap_scaled(ctx,
+                                          x,
+                                          y,
+                                          width,
+                                          height,
+                                          bitmap,
+                                          stride,
+                                          scale_x,
+                                          scale_y,
+                                          color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_BITMAP_SCALED);
+}
+
+/*
+ * Copy a 1bpp bitmap to (x, y), replacing the framebuffer content. The bitmap
+ * uses the same layout as 'epd_draw_bitmap', and the same bit values as the
+ * framebuffer: set bits are white, and clear bits are black. In three-color
+ * models, the red pixels of the area are removed.
+ */
+static inline void epd_copy_bitmap(const epd_ctx_t* ctx,
+                                   uint16_t x,
+                                   uint16_t y,
+                                   uint16_t width,
+                                   uint16_t height,
+                                   const uint8_t* bitmap,
+                                   size_t stride) {
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.copy_bitmap(ctx, x, y, width, height, bitmap, stride);
+    EPD_PROFILE_END(EPD_PROF_COPY_BITMAP);
+}
+
+/*
+ * Set how the core waits while the display is busy, which is most of the time
+ * of a flush. With EPD_WAIT_SLEEP, the core sleeps until the BUSY pin falls (or
+ * another interrupt occurs), and if 'clock_khz' is not zero, the system clock
+ * is lowered to that frequency while waiting, and restored afterwards.
+ * Peripherals that use the system clock, like the UART, don't work at their
+ * configured speed while the clock is lowered, but USB is not affected.
+ */
+static inline void epd_set_wait_mode(epd_ctx_t* ctx,
+                                     enum EEpdWaitModes mode,
+                                     uint32_t clock_khz) {
+    ctx->wait_mode      = mode;
+    ctx->wait_clock_khz = clock_khz;
+}
+
+/*
+ * Set the function that is called while waiting for the display, so the
+ * program can do its own work during a flush. In EPD_WAIT_SLEEP mode, it's
+ * called each time the core wakes up. The 'hook' can be NULL.
+ */
+static inline void epd_set_idle_hook(epd_ctx_t* ctx,
+                                     epd_idle_hook_t hook,
+                                     void* data) {
+    ctx->idle_hook      = hook;
+    ctx->idle_hook_data = data;
+}
+
+/*
+ * Set the font used by the text drawing functions.
+ */
+static inline void epd_set_font(epd_ctx_t* ctx, const epd_font_t* font) {
+    ctx->font = font;
+}
+
+/*
+ * Set the scale of the text drawing functions (see EPD_SCALE_ONE). The glyphs
+ * and their metrics are scaled, so the built-in font can be used for large
+ * text, like 'EPD_SCALE(6)' for 42 pixels tall digits. The text functions of
+ * 'epaper_display_text.h' use it too.
+ */
+static inline void epd_set_text_scale(epd_ctx_t* ctx, uint16_t scale) {
+    ctx->text_scale = scale;
+}
+
+/*
+ * Scale a length in pixels by the specified factor, rounding up.
+ */
+static inline uint16_t epd_scale_length(uint16_t length, uint16_t scale) {
+    return ((uint32_t)length * scale + EPD_SCALE_ONE - 1) >> EPD_SCALE_SHIFT;
+}
+
+/*
+ * Draw the character with the specified Unicode codepoint at (x, y), using the
+ * font of the context.
  */
 static inline void epd_draw_char(const epd_ctx_t* ctx,
                                  uint16_t x,
                                  uint16_t y,
-                                 char c,
+                                 uint32_t codepoint,
                                  uint8_t color) {
-    ctx->display_funcs.draw_char(ctx, x, y, c, color);
+    EPD_PROFILE_BEGIN();
+    ctx->display_funcs.draw_char(ctx, x, y, codepoint, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_CHAR);
 }
 
 /*
- * Draw a string at (x, y)
+ * Draw a UTF-8 string at (x, y), using the font of the context. Each newline
+ * character moves the pen to the start of the next line.
  */
 static inline void epd_draw_str(const epd_ctx_t* ctx,
                                 uint16_t x,
                                 uint16_t y,
                                 const char* str,
                                 uint8_t color) {
+    EPD_PROFILE_BEGIN();
     ctx->display_funcs.draw_str(ctx, x, y, str, color);
+    EPD_PROFILE_END(EPD_PROF_DRAW_STR);
+}
+
+#ifdef __cplusplus
 }
+#endif
 
 #endif /* EPAPER_DISPLAY_H_ */
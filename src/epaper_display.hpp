@@ -0,0 +1,558 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_HPP_
+#define EPAPER_DISPLAY_HPP_ 1
+
+#if !defined(__cplusplus) || __cplusplus < 201703L
+#error "epaper_display.hpp requires C++17."
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "epaper_display.h"
+
+/*
+ * Header-only C++ layer over an initialized 'epd_ctx_t'. The size and
+ * orientation of the display are template parameters, so the row stride and
+ * the panel bounds are constants, and the drawing kernels are specialized for
+ * each color at compile time. They write the framebuffer planes directly, so
+ * nothing goes through the function table of the context; the C API is still
+ * available for everything else (text, images, etc.) through 'Canvas::ctx'.
+ */
+namespace epd {
+
+/*
+ * Colors, with the same meaning and values as 'EEpdColors'.
+ */
+enum class Color : uint8_t {
+    Black  = EPD_COLOR_BLACK,
+    White  = EPD_COLOR_WHITE,
+    Invert = EPD_COLOR_INVERT,
+    Red    = EPD_COLOR_RED,
+};
+
+/*
+ * Clockwise rotation of the canvas coordinates relative to the display. With
+ * 'R90' and 'R270', the width and height of the canvas are swapped.
+ */
+enum class Rotation : uint8_t {
+    R0,
+    R90,
+    R180,
+    R270,
+};
+
+/*
+ * Range of rows [y_start, y_end) in display coordinates, returned by
+ * 'Canvas::changed_rows'.
+ */
+struct Rows {
+    uint16_t y_start, y_end;
+};
+
+namespace detail {
+
+/*
+ * Operation applied to the bits of a framebuffer plane, like the ones of the C
+ * driver.
+ */
+enum class PlaneOp : uint8_t {
+    Clear,
+    Set,
+    Toggle,
+    Keep,
+};
+
+template <Color C>
+inline constexpr PlaneOp black_op = (C == Color::Black)    ? PlaneOp::Clear
+                                    : (C == Color::Invert) ? PlaneOp::Toggle
+                                                           : PlaneOp::Set;
+
+template <Color C>
+inline constexpr PlaneOp red_op = (C == Color::Red)      ? PlaneOp::Set
+                                  : (C == Color::Invert) ? PlaneOp::Keep
+                                                         : PlaneOp::Clear;
+
+template <PlaneOp Op>
+inline void apply(uint8_t& byte, uint8_t mask) {
+    if constexpr (Op == PlaneOp::Clear)
+        byte &= ~mask;
+    else if constexpr (Op == PlaneOp::Set)
+        byte |= mask;
+    else if constexpr (Op == PlaneOp::Toggle)
+        byte ^= mask;
+}
+
+/*
+ * Apply an operation to the span [x0, x1) of a plane row, which must not be
+ * empty. The whole bytes in between the partial ones are filled at once.
+ */
+template <PlaneOp Op>
+inline void fill_plane_span(uint8_t* row, int32_t x0, int32_t x1) {
+    if constexpr (Op == PlaneOp::Keep)
+        return;
+
+    const int32_t first      = x0 / 8;
+    const int32_t last       = (x1 - 1) / 8;
+    const uint8_t first_mask = 0xFF >> (x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+
+    if (first == last) {
+        apply<Op>(row[first], first_mask & last_mask);
+        return;
+    }
+
+    apply<Op>(row[first], first_mask);
+    if constexpr (Op == PlaneOp::Toggle) {
+        for (int32_t i = first + 1; i < last; i++)
+            row[i] ^= 0xFF;
+    } else if (last - first > 1) {
+        std::memset(&row[first + 1],
+                    (Op == PlaneOp::Set) ? 0xFF : 0x00,
+                    last - first - 1);
+    }
+    apply<Op>(row[last], last_mask);
+}
+
+} /* namespace detail */
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Canvas over a context of a 'Width' x 'Height' display (in its native
+ * orientation), such as 'Canvas<128, 296>' for the 2.9" models. The context
+ * must have been initialized for a display of that size, and must outlive the
+ * canvas.
+ *
+ * Drawing functions receive canvas coordinates, which are rotated according
+ * to 'Rot'. The clip rectangle of the context is respected, but its origin is
+ * not applied. Drawing in red is ignored unless the context has a red plane,
+ * and drawing with 'Color::Invert' doesn't modify red pixels, like in the C
+ * driver.
+ *
+ * Each function has a variant with the color as a template argument, for
+ * when it's known at compile time, and one with a runtime color, which
+ * dispatches to the former.
+ */
+template <uint16_t Width, uint16_t Height, Rotation Rot = Rotation::R0>
+class Canvas {
+    static_assert(Width > 0 && Width % 8 == 0,
+                  "The display width must be a positive multiple of 8.");
+    static_assert(Height > 0, "The display height must be positive.");
+
+public:
+    /* Bytes of each framebuffer row, and of each framebuffer plane */
+    static constexpr size_t stride     = Width / 8;
+    static constexpr size_t plane_size = stride * Height;
+
+    /* Size of the canvas, after rotating */
+    static constexpr bool swapped =
+      (Rot == Rotation::R90 || Rot == Rotation::R270);
+    static constexpr uint16_t width  = swapped ? Height : Width;
+    static constexpr uint16_t height = swapped ? Width : Height;
+
+    explicit Canvas(epd_ctx_t& ctx) : ctx_(ctx) {}
+
+    /* Context used by the canvas, for calling the C API */
+    epd_ctx_t& ctx() const {
+        return ctx_;
+    }
+
+    /*------------------------------------------------------------------------*/
+    /* Drawing */
+
+    /*
+     * Fill the whole framebuffer, ignoring the clip rectangle, like
+     * 'epd_clear'.
+     */
+    template <Color C>
+    void clear() const {
+        if (!has_color<C>())
+            return;
+
+        clear_plane<detail::black_op<C>>(ctx_.framebuffer);
+        if (ctx_.framebuffer_red != nullptr)
+            clear_plane<detail::red_op<C>>(ctx_.framebuffer_red);
+    }
+
+    void clear(Color color) const {
+        dispatch(color, [this](auto c) { clear<decltype(c)::value>(); });
+    }
+
+    template <Color C>
+    void pixel(int32_t x, int32_t y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height || !has_color<C>())
+            return;
+
+        int32_t dx, dy;
+        to_display(x, y, dx, dy);
+        if (!inside_clip(dx, dy))
+            return;
+
+        const size_t offset = dy * stride + dx / 8;
+        const uint8_t mask  = 0x80 >> (dx % 8);
+        detail::apply<detail::black_op<C>>(ctx_.framebuffer[offset], mask);
+        if (ctx_.framebuffer_red != nullptr)
+            detail::apply<detail::red_op<C>>(ctx_.framebuffer_red[offset],
+                                             mask);
+    }
+
+    void pixel(int32_t x, int32_t y, Color color) const {
+        dispatch(color, [&](auto c) { pixel<decltype(c)::value>(x, y); });
+    }
+
+    /*
+     * Fill the rectangle of the specified size whose top-left corner is (x, y).
+     * Since rotating a rectangle gives another rectangle, this is always done
+     * with horizontal spans of the framebuffer.
+     */
+    template <Color C>
+    void fill_rect(int32_t x, int32_t y, int32_t w, int32_t h) const {
+        if (w <= 0 || h <= 0 || !has_color<C>())
+            return;
+
+        int32_t x0, y0, x1, y1;
+        to_display_rect(x, y, x + w, y + h, x0, y0, x1, y1);
+        if (!clip_rect(x0, y0, x1, y1))
+            return;
+
+        uint8_t* red = ctx_.framebuffer_red;
+        for (int32_t row = y0; row < y1; row++) {
+            detail::fill_plane_span<detail::black_op<C>>(
+              &ctx_.framebuffer[row * stride],
+              x0,
+              x1);
+            if (red != nullptr)
+                detail::fill_plane_span<detail::red_op<C>>(&red[row * stride],
+                                                           x0,
+                                                           x1);
+        }
+    }
+
+    void fill_rect(int32_t x, int32_t y, int32_t w, int32_t h, Color color)
+      const {
+        dispatch(color,
+                 [&](auto c) { fill_rect<decltype(c)::value>(x, y, w, h); });
+    }
+
+    template <Color C>
+    void hline(int32_t x, int32_t y, int32_t w) const {
+        fill_rect<C>(x, y, w, 1);
+    }
+
+    void hline(int32_t x, int32_t y, int32_t w, Color color) const {
+        fill_rect(x, y, w, 1, color);
+    }
+
+    template <Color C>
+    void vline(int32_t x, int32_t y, int32_t h) const {
+        fill_rect<C>(x, y, 1, h);
+    }
+
+    void vline(int32_t x, int32_t y, int32_t h, Color color) const {
+        fill_rect(x, y, 1, h, color);
+    }
+
+    /*
+     * Draw the outline of a rectangle. The corners are only drawn once, so it
+     * can be inverted.
+     */
+    template <Color C>
+    void rect(int32_t x, int32_t y, int32_t w, int32_t h) const {
+        if (w <= 0 || h <= 0)
+            return;
+        if (w <= 2 || h <= 2) {
+            fill_rect<C>(x, y, w, h);
+            return;
+        }
+
+        hline<C>(x, y, w);
+        hline<C>(x, y + h - 1, w);
+        vline<C>(x, y + 1, h - 2);
+        vline<C>(x + w - 1, y + 1, h - 2);
+    }
+
+    void rect(int32_t x, int32_t y, int32_t w, int32_t h, Color color) const {
+        dispatch(color, [&](auto c) { rect<decltype(c)::value>(x, y, w, h); });
+    }
+
+    /*
+     * Draw the set bits of a 'BW' x 'BH' bitmap with its top-left corner at
+     * (x, y), like 'epd_draw_bitmap'. The bitmap rows are packed MSB-first,
+     * with '(BW + 7) / 8' bytes each. Since the size is known, the loops over
+     * each row can be unrolled.
+     */
+    template <uint16_t BW, uint16_t BH, Color C>
+    void blit(int32_t x, int32_t y, const uint8_t* bitmap) const {
+        static_assert(BW > 0 && BH > 0, "The bitmap can't be empty.");
+        if (!has_color<C>())
+            return;
+
+        if constexpr (Rot == Rotation::R0) {
+            blit_aligned<BW, BH, C>(x, y, bitmap);
+        } else {
+            constexpr size_t src_stride = (BW + 7) / 8;
+            for (uint16_t row = 0; row < BH; row++) {
+                const uint8_t* src = &bitmap[row * src_stride];
+                for (uint16_t col = 0; col < BW; col++)
+                    if (src[col / 8] & (0x80 >> (col % 8)))
+                        pixel<C>(x + col, y + row);
+            }
+        }
+    }
+
+    template <uint16_t BW, uint16_t BH>
+    void blit(int32_t x, int32_t y, const uint8_t* bitmap, Color color) const {
+        dispatch(color, [&](auto c) {
+            blit<BW, BH, decltype(c)::value>(x, y, bitmap);
+        });
+    }
+
+    /*------------------------------------------------------------------------*/
+    /* Updating the display */
+
+    /*
+     * Send the rows that changed to the display, like 'epd_flush'. Returns
+     * true if the display was refreshed.
+     */
+    bool flush() const {
+        return epd_flush(&ctx_);
+    }
+
+    /* Rows sent by the last flush that refreshed the display */
+    Rows changed_rows() const {
+        Rows rows;
+        epd_get_changed_rows(&ctx_, &rows.y_start, &rows.y_end);
+        return rows;
+    }
+
+    /* Make the next flush send the whole framebuffer */
+    void invalidate() const {
+        epd_invalidate(&ctx_);
+    }
+
+    /* Make the next flush only send what changes after this call */
+    void assume_displayed() const {
+        epd_assume_displayed(&ctx_);
+    }
+
+    void sleep() const {
+        epd_sleep(&ctx_);
+    }
+
+private:
+    epd_ctx_t& ctx_;
+
+    template <Color C>
+    struct ColorTag {
+        static constexpr Color value = C;
+    };
+
+    /*
+     * Call 'func' with a tag type for the specified color, so the templated
+     * kernel for each color is instantiated once.
+     */
+    template <typename Func>
+    static void dispatch(Color color, Func&& func) {
+        switch (color) {
+            case Color::Black:
+                func(ColorTag<Color::Black>{});
+                break;
+
+            case Color::White:
+                func(ColorTag<Color::White>{});
+                break;
+
+            case Color::Invert:
+                func(ColorTag<Color::Invert>{});
+                break;
+
+            case Color::Red:
+                func(ColorTag<Color::Red>{});
+                break;
+        }
+    }
+
+    template <Color C>
+    bool has_color() const {
+        if constexpr (C == Color::Red)
+            return ctx_.framebuffer_red != nullptr;
+        else
+            return true;
+    }
+
+    template <detail::PlaneOp Op>
+    static void clear_plane(uint8_t* plane) {
+        if constexpr (Op == detail::PlaneOp::Clear ||
+                      Op == detail::PlaneOp::Set) {
+            std::memset(plane,
+                        (Op == detail::PlaneOp::Set) ? 0xFF : 0x00,
+                        plane_size);
+        } else if constexpr (Op == detail::PlaneOp::Toggle) {
+            for (size_t i = 0; i < plane_size; i++)
+                plane[i] ^= 0xFF;
+        }
+    }
+
+    /* Convert a point from canvas to display coordinates */
+    static constexpr void to_display(int32_t x,
+                                     int32_t y,
+                                     int32_t& dx,
+                                     int32_t& dy) {
+        if constexpr (Rot == Rotation::R0) {
+            dx = x;
+            dy = y;
+        } else if constexpr (Rot == Rotation::R90) {
+            dx = Width - 1 - y;
+            dy = x;
+        } else if constexpr (Rot == Rotation::R180) {
+            dx = Width - 1 - x;
+            dy = Height - 1 - y;
+        } else {
+            dx = y;
+            dy = Height - 1 - x;
+        }
+    }
+
+    /*
+     * Convert the rectangle [x0, x1) x [y0, y1) from canvas to display
+     * coordinates.
+     */
+    static constexpr void to_display_rect(int32_t x0,
+                                          int32_t y0,
+                                          int32_t x1,
+                                          int32_t y1,
+                                          int32_t& dx0,
+                                          int32_t& dy0,
+                                          int32_t& dx1,
+                                          int32_t& dy1) {
+        if constexpr (Rot == Rotation::R0) {
+            dx0 = x0;
+            dy0 = y0;
+            dx1 = x1;
+            dy1 = y1;
+        } else if constexpr (Rot == Rotation::R90) {
+            dx0 = Width - y1;
+            dy0 = x0;
+            dx1 = Width - y0;
+            dy1 = x1;
+        } else if constexpr (Rot == Rotation::R180) {
+            dx0 = Width - x1;
+            dy0 = Height - y1;
+            dx1 = Width - x0;
+            dy1 = Height - y0;
+        } else {
+            dx0 = y0;
+            dy0 = Height - x1;
+            dx1 = y1;
+            dy1 = Height - x0;
+        }
+    }
+
+    bool inside_clip(int32_t x, int32_t y) const {
+        const epd_viewport_t& viewport = ctx_.viewport;
+        return x >= viewport.clip_x0 && x < viewport.clip_x1 &&
+               y >= viewport.clip_y0 && y < viewport.clip_y1;
+    }
+
+    /*
+     * Intersect a rectangle in display coordinates with the clip rectangle.
+     * Returns false if the result is empty.
+     */
+    bool clip_rect(int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+        const epd_viewport_t& viewport = ctx_.viewport;
+        if (x0 < viewport.clip_x0)
+            x0 = viewport.clip_x0;
+        if (y0 < viewport.clip_y0)
+            y0 = viewport.clip_y0;
+        if (x1 > viewport.clip_x1)
+            x1 = viewport.clip_x1;
+        if (y1 > viewport.clip_y1)
+            y1 = viewport.clip_y1;
+        return x0 < x1 && y0 < y1;
+    }
+
+    /*
+     * Draw a bitmap without rotation, shifting each source byte into the (at
+     * most two) framebuffer bytes it spans.
+     */
+    template <uint16_t BW, uint16_t BH, Color C>
+    void blit_aligned(int32_t x, int32_t y, const uint8_t* bitmap) const {
+        constexpr size_t src_stride     = (BW + 7) / 8;
+        constexpr uint8_t src_last_mask = (uint8_t)(0xFF << ((8 - BW % 8) % 8));
+
+        int32_t x0 = x, y0 = y, x1 = x + BW, y1 = y + BH;
+        if (!clip_rect(x0, y0, x1, y1))
+            return;
+
+        const int32_t clip_first      = x0 / 8;
+        const int32_t clip_last       = (x1 - 1) / 8;
+        const uint8_t clip_first_mask = 0xFF >> (x0 % 8);
+        const uint8_t clip_last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+
+        /* Arithmetic shift, so negative coordinates round down */
+        const uint8_t shift       = x & 7;
+        const int32_t first_index = (x - shift) / 8;
+
+        uint8_t* red = ctx_.framebuffer_red;
+        for (int32_t dst_y = y0; dst_y < y1; dst_y++) {
+            const uint8_t* src  = &bitmap[(dst_y - y) * src_stride];
+            const size_t offset = dst_y * stride;
+
+            for (size_t i = 0; i < src_stride; i++) {
+                uint8_t bits = src[i];
+                if (i == src_stride - 1)
+                    bits &= src_last_mask;
+
+                const uint8_t parts[2] = { (uint8_t)(bits >> shift),
+                                           (uint8_t)(bits << (8 - shift)) };
+                for (int j = 0; j < 2; j++) {
+                    const int32_t index = first_index + (int32_t)i + j;
+                    uint8_t mask        = parts[j];
+                    if (mask == 0 || index < clip_first || index > clip_last)
+                        continue;
+
+                    if (index == clip_first)
+                        mask &= clip_first_mask;
+                    if (index == clip_last)
+                        mask &= clip_last_mask;
+
+                    detail::apply<detail::black_op<C>>(
+                      ctx_.framebuffer[offset + index],
+                      mask);
+                    if (red != nullptr)
+                        detail::apply<detail::red_op<C>>(red[offset + index],
+                                                         mask);
+                }
+            }
+        }
+    }
+};
+
+/*
+ * Canvas for the 2.9" models (monochrome or three-color).
+ */
+template <Rotation Rot = Rotation::R0>
+using Canvas2in9 = Canvas<128, 296, Rot>;
+
+} /* namespace epd */
+
+#endif /* EPAPER_DISPLAY_HPP_ */
@@ -23,6 +23,7 @@
 #include "pico/stdlib.h"
 
 #include "epaper_display_utils.h"
+#include "font.h"
 
 /*
  * Display dimensions.
@@ -33,25 +34,117 @@
 #define EPD_WIDTH  128
 #define EPD_HEIGHT 296
 
+/*
+ * Reset timings, in microseconds. The reset pulse and the time before the
+ * controller accepts commands are the minimums from the datasheet; the rest of
+ * the waits are driven by the BUSY pin. The settle time is the delay before
+ * BUSY is guaranteed to reflect a command that was just sent.
+ */
+#define EPD_RESET_PULSE_US    10000
+#define EPD_RESET_RECOVERY_US 10000
+#define EPD_BUSY_SETTLE_US    1000
+
+/* Number of initialization steps that reset the controller */
+#define EPD_RESET_STEPS 3
+
 /* Display commands */
 #define EPD_CMD_DRIVER_OUTPUT_CONTROL       0x01
 #define EPD_CMD_BOOSTER_SOFT_START_CONTROL  0x0C
 #define EPD_CMD_DEEP_SLEEP_MODE             0x10
 #define EPD_CMD_DATA_ENTRY_MODE_SETTING     0x11
 #define EPD_CMD_SW_RESET                    0x12
+#define EPD_CMD_TEMPERATURE_SENSOR_CONTROL  0x18
 #define EPD_CMD_MASTER_ACTIVATION           0x20
 #define EPD_CMD_DISPLAY_UPDATE_CONTROL_1    0x21
 #define EPD_CMD_DISPLAY_UPDATE_CONTROL_2    0x22
 #define EPD_CMD_WRITE_RAM                   0x24
+#define EPD_CMD_WRITE_RAM_PREVIOUS          0x26
 #define EPD_CMD_WRITE_VCOM_REGISTER         0x2C
 #define EPD_CMD_WRITE_LUT_REGISTER          0x32
 #define EPD_CMD_SET_DUMMY_LINE_PERIOD       0x3A
 #define EPD_CMD_SET_GATE_TIME               0x3B
+#define EPD_CMD_BORDER_WAVEFORM_CONTROL     0x3C
 #define EPD_CMD_SET_RAM_X_ADDRESS_START_END 0x44
 #define EPD_CMD_SET_RAM_Y_ADDRESS_START_END 0x45
 #define EPD_CMD_SET_RAM_X_ADDRESS_COUNTER   0x4E
 #define EPD_CMD_SET_RAM_Y_ADDRESS_COUNTER   0x4F
 
+/* In three-color models, the second RAM contains the red plane */
+#define EPD_CMD_WRITE_RAM_RED EPD_CMD_WRITE_RAM_PREVIOUS
+
+/*
+ * Largest integer factor of the rows expanded with 'epd_2in9_expand_lut', and
+ * size of the buffer in which each row is expanded, in bytes.
+ */
+#define EPD_EXPAND_MAX_FACTOR 8
+#define EPD_EXPAND_ROW_BYTES  64
+
+/*
+ * Operations that a color performs on the bits of a framebuffer plane.
+ */
+enum EPlaneOps {
+    PLANE_CLEAR,
+    PLANE_SET,
+    PLANE_TOGGLE,
+    PLANE_KEEP,
+};
+
+/*
+ * Operation of each color on the first plane, and on the red plane. Red pixels
+ * are white in the first plane, so they are white if the red plane is ignored.
+ */
+static const uint8_t epd_2in9_plane_ops[][2] = {
+    [EPD_COLOR_BLACK]  = { PLANE_CLEAR, PLANE_CLEAR },
+    [EPD_COLOR_WHITE]  = { PLANE_SET, PLANE_CLEAR },
+    [EPD_COLOR_INVERT] = { PLANE_TOGGLE, PLANE_KEEP },
+    [EPD_COLOR_RED]    = { PLANE_SET, PLANE_SET },
+};
+
+/*
+ * Bits of each nibble, repeated 2 to EPD_EXPAND_MAX_FACTOR times, for
+ * expanding bitmap rows by an integer factor.
+ */
+static const uint32_t epd_2in9_expand_lut[EPD_EXPAND_MAX_FACTOR - 1][16] = {
+    /* x2 */
+    {
+        0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F, 0xC0, 0xC3, 0xCC, 0xCF,
+        0xF0, 0xF3, 0xFC, 0xFF,
+    },
+    /* x3 */
+    {
+        0x000, 0x007, 0x038, 0x03F, 0x1C0, 0x1C7, 0x1F8, 0x1FF, 0xE00, 0xE07,
+        0xE38, 0xE3F, 0xFC0, 0xFC7, 0xFF8, 0xFFF,
+    },
+    /* x4 */
+    {
+        0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF, 0xF000,
+        0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF,
+    },
+    /* x5 */
+    {
+        0x00000, 0x0001F, 0x003E0, 0x003FF, 0x07C00, 0x07C1F, 0x07FE0, 0x07FFF,
+        0xF8000, 0xF801F, 0xF83E0, 0xF83FF, 0xFFC00, 0xFFC1F, 0xFFFE0, 0xFFFFF,
+    },
+    /* x6 */
+    {
+        0x000000, 0x00003F, 0x000FC0, 0x000FFF, 0x03F000, 0x03F03F, 0x03FFC0,
+        0x03FFFF, 0xFC0000, 0xFC003F, 0xFC0FC0, 0xFC0FFF, 0xFFF000, 0xFFF03F,
+        0xFFFFC0, 0xFFFFFF,
+    },
+    /* x7 */
+    {
+        0x0000000, 0x000007F, 0x0003F80, 0x0003FFF, 0x01FC000, 0x01FC07F,
+        0x01FFF80, 0x01FFFFF, 0xFE00000, 0xFE0007F, 0xFE03F80, 0xFE03FFF,
+        0xFFFC000, 0xFFFC07F, 0xFFFFF80, 0xFFFFFFF,
+    },
+    /* x8 */
+    {
+        0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF, 0x00FF0000, 0x00FF00FF,
+        0x00FFFF00, 0x00FFFFFF, 0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF,
+        0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF,
+    },
+};
+
 /*----------------------------------------------------------------------------*/
 
 static void epd_2in9_load_lut(const epd_ctx_t* ctx) {
@@ -91,15 +184,899 @@ static void epd_2in9_set_cursor(const epd_ctx_t* ctx, uint16_t x, uint16_t y) {
     epd_utils_send_data(ctx, (y >> 8) & 0xFF);
 }
 
-/*----------------------------------------------------------------------------*/
+/*
+ * Check if the specified color can be used by the drawing functions of this
+ * model.
+ */
+static bool epd_2in9_valid_color(const epd_ctx_t* ctx, uint8_t color) {
+    switch (color) {
+        case EPD_COLOR_BLACK:
+        case EPD_COLOR_WHITE:
+        case EPD_COLOR_INVERT:
+            return true;
+
+        case EPD_COLOR_RED:
+            if (ctx->framebuffer_red != NULL)
+                return true;
+            EPD_LOG("EPD_COLOR_RED needs a three-color model.");
+            return false;
+
+        default:
+            EPD_LOG("Invalid color enumerator (%d).", color);
+            return false;
+    }
+}
+
+/*
+ * Apply a plane operation to the set bits of 'mask' in the specified byte.
+ */
+static inline void epd_2in9_apply_op(uint8_t* byte, uint8_t mask, uint8_t op) {
+    switch (op) {
+        case PLANE_CLEAR:
+            *byte &= ~mask;
+            break;
+
+        case PLANE_SET:
+            *byte |= mask;
+            break;
+
+        case PLANE_TOGGLE:
+            *byte ^= mask;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Apply a plane operation to whole bytes. Inverted bytes are processed one
+ * word at a time when possible.
+ */
+static void epd_2in9_apply_op_bytes(uint8_t* bytes, int32_t size, uint8_t op) {
+    int32_t i = 0;
+
+    switch (op) {
+        case PLANE_CLEAR:
+        case PLANE_SET:
+            if (size > 0)
+                memset(bytes, (op == PLANE_SET) ? 0xFF : 0x00, size);
+            break;
+
+        case PLANE_TOGGLE:
+            for (; i + 4 <= size; i += 4) {
+                uint32_t word;
+                memcpy(&word, &bytes[i], sizeof(word));
+                word = ~word;
+                memcpy(&bytes[i], &word, sizeof(word));
+            }
+            for (; i < size; i++)
+                bytes[i] ^= 0xFF;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Draw the set bits of 'mask' in the framebuffer byte at 'offset', in all the
+ * planes.
+ */
+static inline void epd_2in9_apply_mask(const epd_ctx_t* ctx,
+                                       size_t offset,
+                                       uint8_t mask,
+                                       uint8_t color) {
+    epd_2in9_apply_op(&ctx->framebuffer[offset],
+                      mask,
+                      epd_2in9_plane_ops[color][0]);
+    if (ctx->framebuffer_red != NULL)
+        epd_2in9_apply_op(&ctx->framebuffer_red[offset],
+                          mask,
+                          epd_2in9_plane_ops[color][1]);
+}
+
+/*
+ * Draw a single pixel in display coordinates, without clipping.
+ */
+static inline void epd_2in9_put_pixel(const epd_ctx_t* ctx,
+                                      int32_t x,
+                                      int32_t y,
+                                      uint8_t color) {
+    epd_2in9_apply_mask(ctx,
+                        y * (ctx->width / 8) + x / 8,
+                        0x80 >> (x % 8),
+                        color);
+}
+
+/*
+ * Apply a plane operation to the horizontal span [x0, x1) of a plane row. The
+ * partial bytes at each end are masked, and the whole bytes in between are
+ * filled at once.
+ */
+static void epd_2in9_fill_plane_span(uint8_t* row,
+                                     int32_t x0,
+                                     int32_t x1,
+                                     uint8_t op) {
+    const int32_t first      = x0 / 8;
+    const int32_t last       = (x1 - 1) / 8;
+    const uint8_t first_mask = 0xFF >> (x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+
+    if (first == last) {
+        epd_2in9_apply_op(&row[first], first_mask & last_mask, op);
+        return;
+    }
+
+    epd_2in9_apply_op(&row[first], first_mask, op);
+    epd_2in9_apply_op_bytes(&row[first + 1], last - first - 1, op);
+    epd_2in9_apply_op(&row[last], last_mask, op);
+}
+
+/*
+ * Draw the horizontal span [x0, x1) of row 'y', in display coordinates and
+ * without clipping, in all the planes.
+ */
+static void epd_2in9_fill_span(const epd_ctx_t* ctx,
+                               int32_t y,
+                               int32_t x0,
+                               int32_t x1,
+                               uint8_t color) {
+    const size_t offset = y * (ctx->width / 8);
+
+    epd_2in9_fill_plane_span(&ctx->framebuffer[offset],
+                             x0,
+                             x1,
+                             epd_2in9_plane_ops[color][0]);
+    if (ctx->framebuffer_red != NULL)
+        epd_2in9_fill_plane_span(&ctx->framebuffer_red[offset],
+                                 x0,
+                                 x1,
+                                 epd_2in9_plane_ops[color][1]);
+}
+
+/*
+ * Draw the horizontal span [x0, x1) of row 'y', in display coordinates,
+ * clipping it to the clip rectangle of the context.
+ */
+static void epd_2in9_hspan(const epd_ctx_t* ctx,
+                           int32_t y,
+                           int32_t x0,
+                           int32_t x1,
+                           uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    if (y < viewport->clip_y0 || y >= viewport->clip_y1)
+        return;
+
+    if (x0 < viewport->clip_x0)
+        x0 = viewport->clip_x0;
+    if (x1 > viewport->clip_x1)
+        x1 = viewport->clip_x1;
+    if (x0 >= x1)
+        return;
+
+    epd_2in9_fill_span(ctx, y, x0, x1, color);
+}
+
+/*
+ * Draw the vertical span [y0, y1) of column 'x', in display coordinates,
+ * clipping it to the clip rectangle of the context.
+ */
+static void epd_2in9_vspan(const epd_ctx_t* ctx,
+                           int32_t x,
+                           int32_t y0,
+                           int32_t y1,
+                           uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    if (x < viewport->clip_x0 || x >= viewport->clip_x1)
+        return;
+
+    if (y0 < viewport->clip_y0)
+        y0 = viewport->clip_y0;
+    if (y1 > viewport->clip_y1)
+        y1 = viewport->clip_y1;
+    if (y0 >= y1)
+        return;
+
+    const size_t row_size = ctx->width / 8;
+    size_t offset         = y0 * row_size + x / 8;
+    const uint8_t mask    = 0x80 >> (x % 8);
+    for (int32_t y = y0; y < y1; y++, offset += row_size)
+        epd_2in9_apply_mask(ctx, offset, mask, color);
+}
+
+/*
+ * Draw the set bits of a 1bpp bitmap whose top-left corner is at (x, y), in
+ * context coordinates. The bitmap is clipped to the clip rectangle of the
+ * context. Each source byte is shifted into (at most) two framebuffer bytes,
+ * instead of drawing each pixel separately.
+ */
+static void epd_2in9_blit(const epd_ctx_t* ctx,
+                          int32_t x,
+                          int32_t y,
+                          uint16_t width,
+                          uint16_t height,
+                          const uint8_t* bitmap,
+                          size_t stride,
+                          uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    x += viewport->origin_x;
+    y += viewport->origin_y;
+
+    /* Rows of the bitmap that are inside of the clip rectangle */
+    const int32_t src_y0 = (y < viewport->clip_y0) ? viewport->clip_y0 - y : 0;
+    const int32_t src_y1 = (y + height > viewport->clip_y1)
+                             ? viewport->clip_y1 - y
+                             : height;
+    if (src_y0 >= src_y1 || x >= viewport->clip_x1 ||
+        x + width <= viewport->clip_x0 || !epd_2in9_valid_color(ctx, color))
+        return;
+
+    /* Framebuffer bytes of each row that contain the clip rectangle */
+    const int32_t clip_first     = viewport->clip_x0 / 8;
+    const int32_t clip_last      = (viewport->clip_x1 - 1) / 8;
+    const uint8_t clip_first_mask = 0xFF >> (viewport->clip_x0 % 8);
+    const uint8_t clip_last_mask  = 0xFF << (7 - (viewport->clip_x1 - 1) % 8);
+
+    const int32_t row_size    = ctx->width / 8;
+    const uint16_t src_bytes  = (width + 7) / 8;
+    const uint8_t src_last_mask = 0xFF << ((8 - width % 8) % 8);
+    const uint8_t shift       = x & 7;
+    const int32_t first_index = (x - shift) / 8;
+
+    for (int32_t src_y = src_y0; src_y < src_y1; src_y++) {
+        const uint8_t* src  = &bitmap[src_y * stride];
+        const size_t offset = (y + src_y) * row_size;
+
+        for (uint16_t i = 0; i < src_bytes; i++) {
+            uint8_t bits = src[i];
+            if (i == src_bytes - 1)
+                bits &= src_last_mask;
+            if (bits == 0)
+                continue;
+
+            /*
+             * Each source byte spans two destination bytes, unless the bitmap
+             * is aligned.
+             */
+            const uint8_t parts[2] = { bits >> shift,
+                                       (uint8_t)(bits << (8 - shift)) };
+            for (int j = 0; j < ((shift == 0) ? 1 : 2); j++) {
+                const int32_t index = first_index + i + j;
+                uint8_t mask        = parts[j];
+                if (mask == 0 || index < clip_first || index > clip_last)
+                    continue;
+
+                if (index == clip_first)
+                    mask &= clip_first_mask;
+                if (index == clip_last)
+                    mask &= clip_last_mask;
+                epd_2in9_apply_mask(ctx, offset + index, mask, color);
+            }
+        }
+    }
+}
+
+/*
+ * Read the 8 bits of a bitmap row that start at bit 'bit', which can be
+ * negative. Bits outside of the row are read as zero.
+ */
+static inline uint8_t epd_2in9_source_byte(const uint8_t* src,
+                                           int32_t src_bytes,
+                                           int32_t bit) {
+    const int32_t index = bit >> 3;
+    const uint8_t shift = bit & 7;
+
+    const uint8_t hi = (index >= 0 && index < src_bytes) ? src[index] : 0;
+    if (shift == 0)
+        return hi;
+
+    const uint8_t lo =
+      (index + 1 >= 0 && index + 1 < src_bytes) ? src[index + 1] : 0;
+    return (hi << shift) | (lo >> (8 - shift));
+}
+
+/*
+ * Read bit 'bit' of a bitmap row.
+ */
+static inline bool epd_2in9_source_bit(const uint8_t* src, int32_t bit) {
+    return (src[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+/*
+ * First pixel covered by source pixel 'i' when scaled by a fixed-point factor.
+ * Source pixel 'i' covers the pixels [start(i), start(i + 1)).
+ */
+static inline int32_t epd_2in9_scaled_start(int32_t i, uint16_t scale) {
+    return ((uint32_t)i * scale + EPD_SCALE_ONE - 1) >> EPD_SCALE_SHIFT;
+}
+
+/*
+ * Source pixel that covers the scaled pixel 'i', the inverse of
+ * 'epd_2in9_scaled_start'.
+ */
+static inline int32_t epd_2in9_scaled_source(int32_t i, uint16_t scale) {
+    return ((uint32_t)i << EPD_SCALE_SHIFT) / scale;
+}
+
+/*
+ * Expand the bytes [first, last] of a bitmap row by an integer factor, from 2
+ * to EPD_EXPAND_MAX_FACTOR, so each source byte becomes 'factor' bytes of
+ * 'dst'.
+ */
+static void epd_2in9_expand_row(const uint8_t* src,
+                                int32_t first,
+                                int32_t last,
+                                uint8_t factor,
+                                uint8_t* dst) {
+    const uint32_t* lut       = epd_2in9_expand_lut[factor - 2];
+    const uint8_t nibble_bits = factor * 4;
+
+    uint64_t bits     = 0;
+    uint8_t bit_count = 0;
+    for (int32_t i = first; i <= last; i++) {
+        for (int shift = 4; shift >= 0; shift -= 4) {
+            bits = (bits << nibble_bits) | lut[(src[i] >> shift) & 0xF];
+            bit_count += nibble_bits;
+            while (bit_count >= 8) {
+                bit_count -= 8;
+                *dst++ = bits >> bit_count;
+            }
+        }
+    }
+}
+
+/*
+ * Draw the set bits of a 1bpp bitmap scaled by fixed-point factors, with its
+ * top-left corner at (x, y) in context coordinates, using nearest-neighbor
+ * sampling and clipping it to the clip rectangle of the context.
+ *
+ * Each source row is drawn once for all the rows that repeat it. With integer
+ * horizontal factors up to EPD_EXPAND_MAX_FACTOR, the row is expanded through
+ * a lookup table and drawn with 'epd_2in9_blit', with a stride of zero. Other
+ * factors draw each run of set bits of the row as a span.
+ */
+static void epd_2in9_blit_scaled(const epd_ctx_t* ctx,
+                                 int32_t x,
+                                 int32_t y,
+                                 uint16_t width,
+                                 uint16_t height,
+                                 const uint8_t* bitmap,
+                                 size_t stride,
+                                 uint16_t scale_x,
+                                 uint16_t scale_y,
+                                 uint8_t color) {
+    if (scale_x == EPD_SCALE_ONE && scale_y == EPD_SCALE_ONE) {
+        epd_2in9_blit(ctx, x, y, width, height, bitmap, stride, color);
+        return;
+    }
+
+    if (scale_x == 0 || scale_y == 0 || width == 0 || height == 0 ||
+        !epd_2in9_valid_color(ctx, color))
+        return;
+
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t abs_x            = x + viewport->origin_x;
+    const int32_t abs_y            = y + viewport->origin_y;
+    const int32_t scaled_width     = epd_2in9_scaled_start(width, scale_x);
+    const int32_t scaled_height    = epd_2in9_scaled_start(height, scale_y);
+
+    /* Part of the scaled bitmap inside of the clip rectangle */
+    const int32_t dst_x0 =
+      (abs_x < viewport->clip_x0) ? viewport->clip_x0 - abs_x : 0;
+    const int32_t dst_y0 =
+      (abs_y < viewport->clip_y0) ? viewport->clip_y0 - abs_y : 0;
+    const int32_t dst_x1 = (abs_x + scaled_width > viewport->clip_x1)
+                             ? viewport->clip_x1 - abs_x
+                             : scaled_width;
+    const int32_t dst_y1 = (abs_y + scaled_height > viewport->clip_y1)
+                             ? viewport->clip_y1 - abs_y
+                             : scaled_height;
+    if (dst_x0 >= dst_x1 || dst_y0 >= dst_y1)
+        return;
+
+    /* Source columns and rows that cover it */
+    const int32_t src_x0 = epd_2in9_scaled_source(dst_x0, scale_x);
+    const int32_t src_x1 = epd_2in9_scaled_source(dst_x1 - 1, scale_x) + 1;
+    const int32_t src_y0 = epd_2in9_scaled_source(dst_y0, scale_y);
+    const int32_t src_y1 = epd_2in9_scaled_source(dst_y1 - 1, scale_y) + 1;
+
+    /*
+     * Integer factors are expanded from whole source bytes, as long as the
+     * expanded bytes fit in the buffer.
+     */
+    const uint8_t factor = (scale_x % EPD_SCALE_ONE == 0)
+                             ? scale_x >> EPD_SCALE_SHIFT
+                             : 0;
+    const int32_t first_byte = src_x0 / 8;
+    const int32_t last_byte  = (src_x1 - 1) / 8;
+    const bool expand = factor >= 2 && factor <= EPD_EXPAND_MAX_FACTOR &&
+                        (last_byte - first_byte + 1) * factor <=
+                          EPD_EXPAND_ROW_BYTES;
+    const int32_t src_end =
+      (width < (last_byte + 1) * 8) ? width : (last_byte + 1) * 8;
+    uint8_t expanded[EPD_EXPAND_ROW_BYTES];
+
+    for (int32_t src_y = src_y0; src_y < src_y1; src_y++) {
+        const uint8_t* src = &bitmap[src_y * stride];
+
+        /* Rows that repeat this source row, which can be none */
+        int32_t row_y0 = epd_2in9_scaled_start(src_y, scale_y);
+        int32_t row_y1 = epd_2in9_scaled_start(src_y + 1, scale_y);
+        if (row_y0 < dst_y0)
+            row_y0 = dst_y0;
+        if (row_y1 > dst_y1)
+            row_y1 = dst_y1;
+        if (row_y0 >= row_y1)
+            continue;
+
+        if (factor == 1) {
+            epd_2in9_blit(ctx,
+                          x,
+                          y + row_y0,
+                          width,
+                          row_y1 - row_y0,
+                          src,
+                          0,
+                          color);
+            continue;
+        }
+
+        if (expand) {
+            epd_2in9_expand_row(src, first_byte, last_byte, factor, expanded);
+            epd_2in9_blit(ctx,
+                          x + first_byte * 8 * factor,
+                          y + row_y0,
+                          (src_end - first_byte * 8) * factor,
+                          row_y1 - row_y0,
+                          expanded,
+                          0,
+                          color);
+            continue;
+        }
+
+        int32_t src_x = src_x0;
+        while (src_x < src_x1) {
+            if (!epd_2in9_source_bit(src, src_x)) {
+                src_x++;
+                continue;
+            }
+
+            int32_t run_end = src_x + 1;
+            while (run_end < src_x1 && epd_2in9_source_bit(src, run_end))
+                run_end++;
+
+            const int32_t span_x0 =
+              abs_x + epd_2in9_scaled_start(src_x, scale_x);
+            const int32_t span_x1 =
+              abs_x + epd_2in9_scaled_start(run_end, scale_x);
+            for (int32_t row_y = row_y0; row_y < row_y1; row_y++)
+                epd_2in9_hspan(ctx, abs_y + row_y, span_x0, span_x1, color);
+
+            src_x = run_end;
+        }
+    }
+}
+
+/*
+ * Draw a glyph of the font of the context with the pen at (x, y), in context
+ * coordinates, scaled by the text scale of the context.
+ */
+static void epd_2in9_glyph(const epd_ctx_t* ctx,
+                           int32_t x,
+                           int32_t y,
+                           const epd_font_glyph_t* glyph,
+                           uint8_t color) {
+    const uint16_t scale = ctx->text_scale;
+
+    epd_2in9_blit_scaled(ctx,
+                         x + glyph->x_offset * scale / EPD_SCALE_ONE,
+                         y + glyph->y_offset * scale / EPD_SCALE_ONE,
+                         glyph->width,
+                         glyph->height,
+                         &ctx->font->bitmap[glyph->bitmap_offset],
+                         (glyph->width + 7) / 8,
+                         scale,
+                         scale,
+                         color);
+}
+
+/*
+ * Draw a line between two points in display coordinates, clipping it to the
+ * clip rectangle of the context. If 'include_end' is false, the last point is
+ * not drawn, so connected lines don't draw their shared points twice.
+ */
+static void epd_2in9_line(const epd_ctx_t* ctx,
+                          int32_t x0,
+                          int32_t y0,
+                          int32_t x1,
+                          int32_t y1,
+                          bool include_end,
+                          uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+
+    /* Horizontal and vertical lines are drawn as spans */
+    if (y0 == y1) {
+        if (x0 <= x1)
+            epd_2in9_hspan(ctx, y0, x0, x1 + include_end, color);
+        else
+            epd_2in9_hspan(ctx, y0, x1 + !include_end, x0 + 1, color);
+        return;
+    }
+    if (x0 == x1) {
+        if (y0 <= y1)
+            epd_2in9_vspan(ctx, x0, y0, y1 + include_end, color);
+        else
+            epd_2in9_vspan(ctx, x0, y1 + !include_end, y0 + 1, color);
+        return;
+    }
+
+    const int32_t min_x = (x0 < x1) ? x0 : x1;
+    const int32_t max_x = (x0 < x1) ? x1 : x0;
+    const int32_t min_y = (y0 < y1) ? y0 : y1;
+    const int32_t max_y = (y0 < y1) ? y1 : y0;
+
+    /* Lines outside of the clip rectangle are not iterated */
+    if (max_x < viewport->clip_x0 || min_x >= viewport->clip_x1 ||
+        max_y < viewport->clip_y0 || min_y >= viewport->clip_y1)
+        return;
+
+    /*
+     * Only lines that cross the edge of the clip rectangle need to check each
+     * of their pixels.
+     */
+    const bool inside = min_x >= viewport->clip_x0 &&
+                        max_x < viewport->clip_x1 &&
+                        min_y >= viewport->clip_y0 && max_y < viewport->clip_y1;
+
+    const int32_t dx = max_x - min_x;
+    const int32_t dy = max_y - min_y;
+    const int32_t sx = (x0 < x1) ? 1 : -1;
+    const int32_t sy = (y0 < y1) ? 1 : -1;
+    int32_t err      = dx - dy;
+
+    for (;;) {
+        const bool is_end = (x0 == x1 && y0 == y1);
+        if (is_end && !include_end)
+            break;
+
+        if (inside ||
+            (x0 >= viewport->clip_x0 && x0 < viewport->clip_x1 &&
+             y0 >= viewport->clip_y0 && y0 < viewport->clip_y1))
+            epd_2in9_put_pixel(ctx, x0, y0, color);
+
+        if (is_end)
+            break;
+
+        const int32_t e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+/*
+ * Sine of an integer angle in degrees, in Q14 fixed point.
+ */
+static int32_t epd_2in9_sin(int32_t degrees) {
+    static const int16_t sin_table[91] = {
+        0,     286,   572,   857,   1143,  1428,  1713,  1997,  2280,  2563,
+        2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+        5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+        8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860,  10087, 10311,
+        10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+        12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+        14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+        15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+        16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+        16384,
+    };
+
+    degrees = ((degrees % 360) + 360) % 360;
+    if (degrees <= 90)
+        return sin_table[degrees];
+    if (degrees <= 180)
+        return sin_table[180 - degrees];
+    if (degrees <= 270)
+        return -sin_table[degrees - 180];
+    return -sin_table[360 - degrees];
+}
+
+/*
+ * Get the largest distance 'x' from the center such that the pixel at (x, dy)
+ * is inside of a circle of the specified radius, starting the search at the
+ * specified 'x'. Since the result decreases as 'dy' increases, iterating all
+ * the rows of a circle is linear in its radius. Returns -1 if the row is
+ * outside of the circle.
+ */
+static int32_t epd_2in9_circle_extent(int32_t radius, int32_t dy, int32_t x) {
+    /* Using r^2 + r instead of r^2 rounds the distance to the nearest pixel */
+    const int32_t limit = radius * radius + radius;
+    while (x >= 0 && x * x + dy * dy > limit)
+        x--;
+    return x;
+}
+
+/*
+ * Draw row 'y' of the outline of a circle or rounded rectangle. The left half
+ * of the shape is centered at 'left_cx' and the right half at 'right_cx', and
+ * the row covers the distances [inner, outer] from them. Both halves are drawn
+ * as a single span when they touch.
+ */
+static void epd_2in9_ring_row(const epd_ctx_t* ctx,
+                              int32_t y,
+                              int32_t left_cx,
+                              int32_t right_cx,
+                              int32_t inner,
+                              int32_t outer,
+                              uint8_t color) {
+    const int32_t left_end    = left_cx - inner + 1;
+    const int32_t right_start = right_cx + inner;
+
+    if (inner == 0 || left_end >= right_start) {
+        epd_2in9_hspan(ctx, y, left_cx - outer, right_cx + outer + 1, color);
+        return;
+    }
+
+    epd_2in9_hspan(ctx, y, left_cx - outer, left_end, color);
+    epd_2in9_hspan(ctx, y, right_start, right_cx + outer + 1, color);
+}
+
+/*
+ * Draw the outline of a rounded rectangle whose corners are quarter circles
+ * with the specified radius, centered at the specified coordinates (in display
+ * coordinates). A circle is a rounded rectangle whose four corners share the
+ * same center. Each pixel is only drawn once.
+ */
+static void epd_2in9_rounded_outline(const epd_ctx_t* ctx,
+                                     int32_t left_cx,
+                                     int32_t top_cy,
+                                     int32_t right_cx,
+                                     int32_t bottom_cy,
+                                     int32_t radius,
+                                     uint8_t color) {
+    /* Don't iterate shapes that are completely outside of the clip rectangle */
+    const epd_viewport_t* viewport = &ctx->viewport;
+    if (right_cx + radius < viewport->clip_x0 ||
+        left_cx - radius >= viewport->clip_x1 ||
+        bottom_cy + radius < viewport->clip_y0 ||
+        top_cy - radius >= viewport->clip_y1)
+        return;
+
+    int32_t outer = radius;
+    for (int32_t dy = 0; dy <= radius; dy++) {
+        outer = epd_2in9_circle_extent(radius, dy, outer);
+
+        /*
+         * Fill the gap between this row and the next one, so the outline is
+         * connected.
+         */
+        const int32_t next  = epd_2in9_circle_extent(radius, dy + 1, outer);
+        const int32_t inner = (next < outer) ? next + 1 : outer;
+
+        if (dy == 0 && top_cy != bottom_cy) {
+            /* Straight vertical edges, including the center rows */
+            epd_2in9_vspan(ctx, left_cx - radius, top_cy, bottom_cy + 1, color);
+            epd_2in9_vspan(ctx,
+                           right_cx + radius,
+                           top_cy,
+                           bottom_cy + 1,
+                           color);
+        } else if (dy == 0) {
+            epd_2in9_ring_row(ctx, top_cy, left_cx, right_cx, inner, outer, color);
+        } else {
+            epd_2in9_ring_row(ctx,
+                              top_cy - dy,
+                              left_cx,
+                              right_cx,
+                              inner,
+                              outer,
+                              color);
+            epd_2in9_ring_row(ctx,
+                              bottom_cy + dy,
+                              left_cx,
+                              right_cx,
+                              inner,
+                              outer,
+                              color);
+        }
+    }
+}
+
+/*
+ * Fill a rounded rectangle whose corners are quarter circles with the specified
+ * radius, centered at the specified coordinates (in display coordinates). Each
+ * row is drawn as a single span.
+ */
+static void epd_2in9_rounded_fill(const epd_ctx_t* ctx,
+                                  int32_t left_cx,
+                                  int32_t top_cy,
+                                  int32_t right_cx,
+                                  int32_t bottom_cy,
+                                  int32_t radius,
+                                  uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    if (right_cx + radius < viewport->clip_x0 ||
+        left_cx - radius >= viewport->clip_x1 ||
+        bottom_cy + radius < viewport->clip_y0 ||
+        top_cy - radius >= viewport->clip_y1)
+        return;
 
-bool epd_2in9_init_display(const epd_ctx_t* ctx) {
-    /* Reset and initialize display */
-    epd_2in9_reset(ctx);
+    for (int32_t y = top_cy; y <= bottom_cy; y++)
+        epd_2in9_hspan(ctx, y, left_cx - radius, right_cx + radius + 1, color);
 
-    epd_utils_send_command(ctx, EPD_CMD_SW_RESET);
-    sleep_ms(10); /* Wait for reset to complete before checking BUSY */
+    int32_t outer = radius;
+    for (int32_t dy = 1; dy <= radius; dy++) {
+        outer = epd_2in9_circle_extent(radius, dy, outer);
+        epd_2in9_hspan(ctx,
+                       top_cy - dy,
+                       left_cx - outer,
+                       right_cx + outer + 1,
+                       color);
+        epd_2in9_hspan(ctx,
+                       bottom_cy + dy,
+                       left_cx - outer,
+                       right_cx + outer + 1,
+                       color);
+    }
+}
+
+/*
+ * Check if the point (x, y), relative to the center of an arc, is inside of the
+ * angle range of the arc. The 'start' and 'end' vectors point to the limits of
+ * the arc, and 'sweep' is the angle between them, in degrees.
+ */
+static bool epd_2in9_arc_contains(int32_t x,
+                                  int32_t y,
+                                  int32_t start_x,
+                                  int32_t start_y,
+                                  int32_t end_x,
+                                  int32_t end_y,
+                                  int32_t sweep) {
+    /*
+     * The cross product of two vectors is positive when the second one is
+     * clockwise from the first one (since the Y axis points down).
+     */
+    const int32_t from_start = start_x * y - start_y * x;
+    const int32_t to_end     = x * end_y - y * end_x;
+
+    if (sweep <= 180)
+        return from_start >= 0 && to_end >= 0;
+    return from_start >= 0 || to_end >= 0;
+}
+
+/*
+ * Write the rows [y_start, y_end) of a framebuffer plane to the specified RAM
+ * of the display, which must be inside of the current window.
+ */
+static void epd_2in9_write_rows(const epd_ctx_t* ctx,
+                                uint8_t command,
+                                const uint8_t* plane,
+                                uint16_t y_start,
+                                uint16_t y_end) {
+    const size_t row_size = ctx->width / 8;
+
+    epd_2in9_set_cursor(ctx, 0, y_start);
+    epd_utils_send_command(ctx, command);
+    epd_utils_send_data_buffer(ctx,
+                               &plane[y_start * row_size],
+                               (y_end - y_start) * row_size);
+}
+
+/*
+ * Refresh the display with the content of its memory, and wait until it's done.
+ */
+static void epd_2in9_refresh(const epd_ctx_t* ctx) {
+    epd_utils_send_command(ctx, EPD_CMD_DISPLAY_UPDATE_CONTROL_2);
+    epd_utils_send_data(ctx, 0xF7); /* Full update with LUT from register */
+
+    epd_utils_send_command(ctx, EPD_CMD_MASTER_ACTIVATION);
     epd_utils_wait_until_idle(ctx);
+}
+
+/*
+ * Move the content of the clip rectangle of a framebuffer plane 'dx' pixels to
+ * the right and 'dy' pixels down. The content moved outside of the clip
+ * rectangle is lost, and the exposed area is not modified.
+ */
+static void epd_2in9_scroll_plane(const epd_ctx_t* ctx,
+                                  uint8_t* plane,
+                                  int32_t dx,
+                                  int32_t dy) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t x0               = viewport->clip_x0;
+    const int32_t y0               = viewport->clip_y0;
+    const int32_t x1               = viewport->clip_x1;
+    const int32_t y1               = viewport->clip_y1;
+    const int32_t row_size         = ctx->width / 8;
+
+    /*
+     * Vertical scrolls of the whole display width move all the rows with a
+     * single 'memmove'.
+     */
+    if (dx == 0 && x0 == 0 && x1 == (int32_t)ctx->width) {
+        const int32_t distance = (dy < 0) ? -dy : dy;
+        const int32_t moved    = (distance < y1 - y0) ? y1 - y0 - distance : 0;
+        if (moved > 0) {
+            const int32_t src_y = (dy > 0) ? y0 : y0 - dy;
+            memmove(&plane[(src_y + dy) * row_size],
+                    &plane[src_y * row_size],
+                    moved * row_size);
+        }
+        return;
+    }
+
+    /*
+     * Otherwise, each row is copied from its source row, shifting it by 'dx'
+     * pixels inside of the clip rectangle. The rows are processed in the
+     * opposite direction of the scroll, so the source rows are not overwritten
+     * before they are read. The bytes of each row are processed in the same
+     * way, since each byte is read from the byte at the same position and the
+     * ones before it (or after it, when scrolling left), so rows can be shifted
+     * in place.
+     */
+    const int32_t first      = x0 / 8;
+    const int32_t last       = (x1 - 1) / 8;
+    const uint8_t first_mask = 0xFF >> (x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+    const int32_t x_step     = (dx > 0) ? -1 : 1;
+
+    const int32_t step = (dy > 0) ? -1 : 1;
+    int32_t y          = (dy > 0) ? y1 - 1 : y0;
+    for (; y >= y0 && y < y1; y += step) {
+        const int32_t src_y = y - dy;
+        if (src_y < y0 || src_y >= y1)
+            continue;
+
+        const uint8_t* src = &plane[src_y * row_size];
+        uint8_t* dst       = &plane[y * row_size];
+
+        int32_t index = (dx > 0) ? last : first;
+        for (; index >= first && index <= last; index += x_step) {
+            uint8_t mask = 0xFF;
+            if (index == first)
+                mask &= first_mask;
+            if (index == last)
+                mask &= last_mask;
+
+            const uint8_t bits =
+              epd_2in9_source_byte(src, row_size, index * 8 - dx);
+            dst[index] = (dst[index] & ~mask) | (bits & mask);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+enum EEpdInitWait epd_2in9_init_step(const epd_ctx_t* ctx,
+                                     uint8_t step,
+                                     uint32_t* delay_us) {
+    switch (step) {
+        case 0:
+            /* Start the hardware reset pulse */
+            gpio_put(ctx->pins.res, 0);
+            *delay_us = EPD_RESET_PULSE_US;
+            return EPD_INIT_WAIT_TIME;
+
+        case 1:
+            /* End the pulse, and wait for the controller to boot */
+            gpio_put(ctx->pins.res, 1);
+            *delay_us = EPD_RESET_RECOVERY_US;
+            return EPD_INIT_WAIT_BUSY;
+
+        case 2:
+            epd_utils_send_command(ctx, EPD_CMD_SW_RESET);
+            *delay_us = EPD_BUSY_SETTLE_US;
+            return EPD_INIT_WAIT_BUSY;
+
+        default:
+            break;
+    }
 
     epd_utils_send_command(ctx, EPD_CMD_DRIVER_OUTPUT_CONTROL);
     epd_utils_send_data(ctx, (EPD_HEIGHT - 1) & 0xFF);
@@ -130,83 +1107,191 @@ bool epd_2in9_init_display(const epd_ctx_t* ctx) {
     epd_utils_send_data(ctx, 0x00);
     epd_utils_send_data(ctx, 0x80);
 
-    /* Clear framebuffer */
-    memset(ctx->framebuffer, 0xFF, ctx->framebuffer_size);
-
-    return true;
+    *delay_us = 0;
+    return EPD_INIT_DONE;
 }
 
 void epd_2in9_reset(const epd_ctx_t* ctx) {
-    gpio_put(ctx->pins.res, 1);
-    sleep_ms(200);
     gpio_put(ctx->pins.res, 0);
-    sleep_ms(5);
+    sleep_us(EPD_RESET_PULSE_US);
     gpio_put(ctx->pins.res, 1);
-    sleep_ms(200);
+    sleep_us(EPD_RESET_RECOVERY_US);
+    epd_utils_wait_until_idle(ctx);
+}
+
+void epd_2in9_flush(const epd_ctx_t* ctx, uint16_t y_start, uint16_t y_end) {
+    /*
+     * The display keeps the rows that are not written in its memory, so only
+     * the changed ones are sent. The whole display is still refreshed.
+     */
+    epd_2in9_set_window(ctx, 0, y_start, ctx->width - 1, y_end - 1);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM,
+                        ctx->framebuffer,
+                        y_start,
+                        y_end);
+    epd_2in9_refresh(ctx);
+}
+
+void epd_2in9_sleep(const epd_ctx_t* ctx) {
+    epd_utils_send_command(ctx, EPD_CMD_DEEP_SLEEP_MODE);
+    epd_utils_send_data(ctx, 0x01);
 }
 
-void epd_2in9_flush(const epd_ctx_t* ctx) {
+void epd_2in9_load_frame(const epd_ctx_t* ctx) {
     epd_2in9_set_window(ctx, 0, 0, ctx->width - 1, ctx->height - 1);
-    epd_2in9_set_cursor(ctx, 0, 0);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM,
+                        ctx->framebuffer,
+                        0,
+                        ctx->height);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM_PREVIOUS,
+                        ctx->framebuffer,
+                        0,
+                        ctx->height);
+}
 
-    epd_utils_send_command(ctx, EPD_CMD_WRITE_RAM);
-    epd_utils_send_data_buffer(ctx, ctx->framebuffer, ctx->framebuffer_size);
+enum EEpdInitWait epd_2in9_bwr_init_step(const epd_ctx_t* ctx,
+                                         uint8_t step,
+                                         uint32_t* delay_us) {
+    /* The controller is reset like in the monochrome model */
+    if (step < EPD_RESET_STEPS)
+        return epd_2in9_init_step(ctx, step, delay_us);
 
-    epd_utils_send_command(ctx, EPD_CMD_DISPLAY_UPDATE_CONTROL_2);
-    epd_utils_send_data(ctx, 0xF7); /* Full update with LUT from register */
+    epd_utils_send_command(ctx, EPD_CMD_DRIVER_OUTPUT_CONTROL);
+    epd_utils_send_data(ctx, (EPD_HEIGHT - 1) & 0xFF);
+    epd_utils_send_data(ctx, ((EPD_HEIGHT - 1) >> 8) & 0xFF);
+    epd_utils_send_data(ctx, 0x00);
 
-    epd_utils_send_command(ctx, EPD_CMD_MASTER_ACTIVATION);
-    epd_utils_wait_until_idle(ctx);
+    epd_utils_send_command(ctx, EPD_CMD_DATA_ENTRY_MODE_SETTING);
+    epd_utils_send_data(ctx, 0x03);
+
+    epd_utils_send_command(ctx, EPD_CMD_BORDER_WAVEFORM_CONTROL);
+    epd_utils_send_data(ctx, 0x05);
+
+    epd_utils_send_command(ctx, EPD_CMD_DISPLAY_UPDATE_CONTROL_1);
+    epd_utils_send_data(ctx, 0x00);
+    epd_utils_send_data(ctx, 0x80);
+
+    /*
+     * The three-color waveforms are stored in the controller, and selected
+     * with its internal temperature sensor, so no LUT is loaded.
+     */
+    epd_utils_send_command(ctx, EPD_CMD_TEMPERATURE_SENSOR_CONTROL);
+    epd_utils_send_data(ctx, 0x80);
+
+    *delay_us = 0;
+    return EPD_INIT_DONE;
 }
 
-void epd_2in9_sleep(const epd_ctx_t* ctx) {
-    epd_utils_send_command(ctx, EPD_CMD_DEEP_SLEEP_MODE);
-    epd_utils_send_data(ctx, 0x01);
+void epd_2in9_bwr_flush(const epd_ctx_t* ctx,
+                        uint16_t y_start,
+                        uint16_t y_end) {
+    /* Both planes of the changed rows are sent back to back */
+    epd_2in9_set_window(ctx, 0, y_start, ctx->width - 1, y_end - 1);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM,
+                        ctx->framebuffer,
+                        y_start,
+                        y_end);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM_RED,
+                        ctx->framebuffer_red,
+                        y_start,
+                        y_end);
+    epd_2in9_refresh(ctx);
+}
+
+void epd_2in9_bwr_load_frame(const epd_ctx_t* ctx) {
+    epd_2in9_set_window(ctx, 0, 0, ctx->width - 1, ctx->height - 1);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM,
+                        ctx->framebuffer,
+                        0,
+                        ctx->height);
+    epd_2in9_write_rows(ctx,
+                        EPD_CMD_WRITE_RAM_RED,
+                        ctx->framebuffer_red,
+                        0,
+                        ctx->height);
 }
 
 void epd_2in9_clear(const epd_ctx_t* ctx, uint8_t color) {
-    uint8_t fill_value;
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
 
-    switch (color) {
-        case EPD_COLOR_BLACK:
-            fill_value = 0x00;
-            break;
+    epd_2in9_apply_op_bytes(ctx->framebuffer,
+                            ctx->framebuffer_size,
+                            epd_2in9_plane_ops[color][0]);
+    if (ctx->framebuffer_red != NULL)
+        epd_2in9_apply_op_bytes(ctx->framebuffer_red,
+                                ctx->framebuffer_size,
+                                epd_2in9_plane_ops[color][1]);
+}
 
-        case EPD_COLOR_WHITE:
-            fill_value = 0xFF;
-            break;
+void epd_2in9_scroll(const epd_ctx_t* ctx,
+                     int16_t dx,
+                     int16_t dy,
+                     uint8_t color) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t x0               = viewport->clip_x0;
+    const int32_t y0               = viewport->clip_y0;
+    const int32_t x1               = viewport->clip_x1;
+    const int32_t y1               = viewport->clip_y1;
 
-        default:
-            EPD_LOG("Invalid color enumerator (%d).", color);
-            return;
+    if ((dx == 0 && dy == 0) || x0 >= x1 || y0 >= y1 ||
+        !epd_2in9_valid_color(ctx, color))
+        return;
+
+    if (color == EPD_COLOR_INVERT) {
+        EPD_LOG("The exposed area can't be filled with EPD_COLOR_INVERT.");
+        return;
     }
 
-    memset(ctx->framebuffer, fill_value, ctx->framebuffer_size);
+    epd_2in9_scroll_plane(ctx, ctx->framebuffer, dx, dy);
+    if (ctx->framebuffer_red != NULL)
+        epd_2in9_scroll_plane(ctx, ctx->framebuffer_red, dx, dy);
+
+    /*
+     * The exposed rows are at the top when scrolling down, and vice versa.
+     * The exposed columns are at the left when scrolling right, and vice
+     * versa.
+     */
+    const int32_t exposed_y0 = (dy > 0) ? y0 : y1 + dy;
+    const int32_t exposed_y1 = (dy > 0) ? y0 + dy : y1;
+
+    int32_t exposed_x0 = (dx > 0) ? x0 : x1 + dx;
+    int32_t exposed_x1 = (dx > 0) ? x0 + dx : x1;
+    if (exposed_x0 < x0)
+        exposed_x0 = x0;
+    if (exposed_x1 > x1)
+        exposed_x1 = x1;
+
+    for (int32_t y = y0; y < y1; y++) {
+        if (y >= exposed_y0 && y < exposed_y1)
+            epd_2in9_fill_span(ctx, y, x0, x1, color);
+        else if (exposed_x0 < exposed_x1)
+            epd_2in9_fill_span(ctx, y, exposed_x0, exposed_x1, color);
+    }
 }
 
 void epd_2in9_draw_pixel(const epd_ctx_t* ctx,
                          uint16_t x,
                          uint16_t y,
                          uint8_t color) {
-    if (x >= ctx->width || y >= ctx->height)
-        return;
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t abs_x            = x + viewport->origin_x;
+    const int32_t abs_y            = y + viewport->origin_y;
 
-    uint32_t addr = (x / 8) + y * (ctx->width / 8);
-    uint8_t bit   = 7 - (x % 8);
-
-    switch (color) {
-        case EPD_COLOR_BLACK:
-            ctx->framebuffer[addr] &= ~(1 << bit);
-            break;
+    if (abs_x < viewport->clip_x0 || abs_x >= viewport->clip_x1 ||
+        abs_y < viewport->clip_y0 || abs_y >= viewport->clip_y1)
+        return;
 
-        case EPD_COLOR_WHITE:
-            ctx->framebuffer[addr] |= (1 << bit);
-            break;
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
 
-        default:
-            EPD_LOG("Invalid color enumerator (%d).", color);
-            return;
-    }
+    epd_2in9_put_pixel(ctx, abs_x, abs_y, color);
 }
 
 void epd_2in9_draw_line(const epd_ctx_t* ctx,
@@ -215,28 +1300,18 @@ void epd_2in9_draw_line(const epd_ctx_t* ctx,
                         uint16_t x1,
                         uint16_t y1,
                         uint8_t color) {
-    int16_t dx  = abs(x1 - x0);
-    int16_t dy  = abs(y1 - y0);
-    int16_t sx  = x0 < x1 ? 1 : -1;
-    int16_t sy  = y0 < y1 ? 1 : -1;
-    int16_t err = dx - dy;
-
-    for (;;) {
-        epd_2in9_draw_pixel(ctx, x0, y0, color);
-
-        if (x0 == x1 && y0 == y1)
-            break;
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
 
-        int16_t e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
+    const int32_t origin_x = ctx->viewport.origin_x;
+    const int32_t origin_y = ctx->viewport.origin_y;
+    epd_2in9_line(ctx,
+                  x0 + origin_x,
+                  y0 + origin_y,
+                  x1 + origin_x,
+                  y1 + origin_y,
+                  true,
+                  color);
 }
 
 void epd_2in9_draw_rect(const epd_ctx_t* ctx,
@@ -245,20 +1320,26 @@ void epd_2in9_draw_rect(const epd_ctx_t* ctx,
                         uint16_t width,
                         uint16_t height,
                         uint8_t color) {
-    epd_2in9_draw_line(ctx, x, y, x + width - 1, y, color);
-    epd_2in9_draw_line(ctx,
-                       x + width - 1,
-                       y,
-                       x + width - 1,
-                       y + height - 1,
-                       color);
-    epd_2in9_draw_line(ctx,
-                       x + width - 1,
-                       y + height - 1,
-                       x,
-                       y + height - 1,
-                       color);
-    epd_2in9_draw_line(ctx, x, y + height - 1, x, y, color);
+    if (width == 0 || height == 0 || !epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t x0 = x + ctx->viewport.origin_x;
+    const int32_t y0 = y + ctx->viewport.origin_y;
+    const int32_t x1 = x0 + width;
+    const int32_t y1 = y0 + height;
+
+    /*
+     * The vertical edges don't include the corners, so no pixel is drawn more
+     * than once.
+     */
+    epd_2in9_hspan(ctx, y0, x0, x1, color);
+    if (height > 1)
+        epd_2in9_hspan(ctx, y1 - 1, x0, x1, color);
+    if (height > 2) {
+        epd_2in9_vspan(ctx, x0, y0 + 1, y1 - 1, color);
+        if (width > 1)
+            epd_2in9_vspan(ctx, x1 - 1, y0 + 1, y1 - 1, color);
+    }
 }
 
 void epd_2in9_draw_filled_rect(const epd_ctx_t* ctx,
@@ -267,23 +1348,404 @@ void epd_2in9_draw_filled_rect(const epd_ctx_t* ctx,
                                uint16_t width,
                                uint16_t height,
                                uint8_t color) {
-    for (uint16_t i = 0; i < height; i++)
-        for (uint16_t j = 0; j < width; j++)
-            epd_2in9_draw_pixel(ctx, x + j, y + i, color);
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    /* Intersect the rectangle with the clip rectangle once */
+    const epd_viewport_t* viewport = &ctx->viewport;
+    int32_t x0                     = x + viewport->origin_x;
+    int32_t y0                     = y + viewport->origin_y;
+    int32_t x1                     = x0 + width;
+    int32_t y1                     = y0 + height;
+
+    if (x0 < viewport->clip_x0)
+        x0 = viewport->clip_x0;
+    if (y0 < viewport->clip_y0)
+        y0 = viewport->clip_y0;
+    if (x1 > viewport->clip_x1)
+        x1 = viewport->clip_x1;
+    if (y1 > viewport->clip_y1)
+        y1 = viewport->clip_y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int32_t cur_y = y0; cur_y < y1; cur_y++)
+        epd_2in9_fill_span(ctx, cur_y, x0, x1, color);
+}
+
+void epd_2in9_draw_circle(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t radius,
+                          uint8_t color) {
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t cx = x + ctx->viewport.origin_x;
+    const int32_t cy = y + ctx->viewport.origin_y;
+    epd_2in9_rounded_outline(ctx, cx, cy, cx, cy, radius, color);
+}
+
+void epd_2in9_draw_filled_circle(const epd_ctx_t* ctx,
+                                 uint16_t x,
+                                 uint16_t y,
+                                 uint16_t radius,
+                                 uint8_t color) {
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t cx = x + ctx->viewport.origin_x;
+    const int32_t cy = y + ctx->viewport.origin_y;
+    epd_2in9_rounded_fill(ctx, cx, cy, cx, cy, radius, color);
+}
+
+void epd_2in9_draw_arc(const epd_ctx_t* ctx,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t radius,
+                       int16_t start_angle,
+                       int16_t end_angle,
+                       uint8_t color) {
+    if (end_angle - start_angle >= 360) {
+        epd_2in9_draw_circle(ctx, x, y, radius, color);
+        return;
+    }
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t cx               = x + viewport->origin_x;
+    const int32_t cy               = y + viewport->origin_y;
+    if (cx + radius < viewport->clip_x0 || cx - radius >= viewport->clip_x1 ||
+        cy + radius < viewport->clip_y0 || cy - radius >= viewport->clip_y1)
+        return;
+
+    /*
+     * Arcs without a sweep are empty, since the angle check below would also
+     * accept the points in the opposite direction.
+     */
+    const int32_t sweep = (((end_angle - start_angle) % 360) + 360) % 360;
+    if (sweep == 0)
+        return;
+
+    const int32_t start_x = epd_2in9_sin(start_angle + 90);
+    const int32_t start_y = epd_2in9_sin(start_angle);
+    const int32_t end_x   = epd_2in9_sin(end_angle + 90);
+    const int32_t end_y   = epd_2in9_sin(end_angle);
+
+    /*
+     * Same rows as 'epd_2in9_rounded_outline', but each pixel needs to be
+     * checked against the angle range.
+     */
+    int32_t outer = radius;
+    for (int32_t dy = 0; dy <= radius; dy++) {
+        outer               = epd_2in9_circle_extent(radius, dy, outer);
+        const int32_t next  = epd_2in9_circle_extent(radius, dy + 1, outer);
+        const int32_t inner = (next < outer) ? next + 1 : outer;
+
+        for (int32_t side = -1; side <= 1; side += 2) {
+            const int32_t py = side * dy;
+            if (dy == 0 && side > 0)
+                break;
+            if (cy + py < viewport->clip_y0 || cy + py >= viewport->clip_y1)
+                continue;
+
+            for (int32_t px = -outer; px <= outer; px++) {
+                if (inner > 0 && px > -inner && px < inner)
+                    continue;
+                if (cx + px < viewport->clip_x0 || cx + px >= viewport->clip_x1)
+                    continue;
+
+                if (epd_2in9_arc_contains(px,
+                                          py,
+                                          start_x,
+                                          start_y,
+                                          end_x,
+                                          end_y,
+                                          sweep))
+                    epd_2in9_put_pixel(ctx, cx + px, cy + py, color);
+            }
+        }
+    }
+}
+
+void epd_2in9_draw_round_rect(const epd_ctx_t* ctx,
+                              uint16_t x,
+                              uint16_t y,
+                              uint16_t width,
+                              uint16_t height,
+                              uint16_t radius,
+                              uint8_t color) {
+    const uint16_t max_radius = ((width < height) ? width : height) / 2;
+    if (radius > max_radius)
+        radius = max_radius;
+
+    if (radius == 0) {
+        epd_2in9_draw_rect(ctx, x, y, width, height, color);
+        return;
+    }
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t x0 = x + ctx->viewport.origin_x;
+    const int32_t y0 = y + ctx->viewport.origin_y;
+    epd_2in9_rounded_outline(ctx,
+                             x0 + radius,
+                             y0 + radius,
+                             x0 + width - 1 - radius,
+                             y0 + height - 1 - radius,
+                             radius,
+                             color);
+}
+
+void epd_2in9_draw_filled_round_rect(const epd_ctx_t* ctx,
+                                     uint16_t x,
+                                     uint16_t y,
+                                     uint16_t width,
+                                     uint16_t height,
+                                     uint16_t radius,
+                                     uint8_t color) {
+    const uint16_t max_radius = ((width < height) ? width : height) / 2;
+    if (radius > max_radius)
+        radius = max_radius;
+
+    if (radius == 0) {
+        epd_2in9_draw_filled_rect(ctx, x, y, width, height, color);
+        return;
+    }
+    if (!epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t x0 = x + ctx->viewport.origin_x;
+    const int32_t y0 = y + ctx->viewport.origin_y;
+    epd_2in9_rounded_fill(ctx,
+                          x0 + radius,
+                          y0 + radius,
+                          x0 + width - 1 - radius,
+                          y0 + height - 1 - radius,
+                          radius,
+                          color);
+}
+
+void epd_2in9_draw_polygon(const epd_ctx_t* ctx,
+                           const epd_point_t* points,
+                           size_t count,
+                           uint8_t color) {
+    if (count == 0 || !epd_2in9_valid_color(ctx, color))
+        return;
+
+    const int32_t origin_x = ctx->viewport.origin_x;
+    const int32_t origin_y = ctx->viewport.origin_y;
+
+    if (count <= 2) {
+        const epd_point_t* last = &points[count - 1];
+        epd_2in9_line(ctx,
+                      points[0].x + origin_x,
+                      points[0].y + origin_y,
+                      last->x + origin_x,
+                      last->y + origin_y,
+                      true,
+                      color);
+        return;
+    }
+
+    /*
+     * The last point of each edge is the first point of the next one, so it's
+     * not drawn twice.
+     */
+    for (size_t i = 0; i < count; i++) {
+        const epd_point_t* from = &points[i];
+        const epd_point_t* to   = &points[(i + 1) % count];
+        epd_2in9_line(ctx,
+                      from->x + origin_x,
+                      from->y + origin_y,
+                      to->x + origin_x,
+                      to->y + origin_y,
+                      false,
+                      color);
+    }
+}
+
+void epd_2in9_draw_filled_polygon(const epd_ctx_t* ctx,
+                                  const epd_point_t* points,
+                                  size_t count,
+                                  uint8_t color) {
+    if (count < 3 || !epd_2in9_valid_color(ctx, color))
+        return;
+
+    if (count > EPD_POLYGON_MAX_POINTS) {
+        EPD_LOG("Too many polygon points (%d, maximum is %d).",
+                (int)count,
+                EPD_POLYGON_MAX_POINTS);
+        return;
+    }
+
+    /* Only iterate the rows of the polygon that are inside the clip rectangle */
+    const epd_viewport_t* viewport = &ctx->viewport;
+    int32_t min_y                  = points[0].y;
+    int32_t max_y                  = points[0].y;
+    for (size_t i = 1; i < count; i++) {
+        if (points[i].y < min_y)
+            min_y = points[i].y;
+        if (points[i].y > max_y)
+            max_y = points[i].y;
+    }
+    min_y += viewport->origin_y;
+    max_y += viewport->origin_y;
+    if (min_y < viewport->clip_y0)
+        min_y = viewport->clip_y0;
+    if (max_y > viewport->clip_y1)
+        max_y = viewport->clip_y1;
+
+    /*
+     * For each row, find the X coordinates where the edges cross the center of
+     * the row, in 24.8 fixed point. Pixels whose centers are between pairs of
+     * crossings are inside of the polygon (even-odd rule), so the vertices are
+     * placed at the corners of the pixels.
+     */
+    int32_t crossings[EPD_POLYGON_MAX_POINTS];
+    for (int32_t y = min_y; y < max_y; y++) {
+        const int32_t local_y = y - viewport->origin_y;
+
+        size_t crossing_count = 0;
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            const int32_t x0 = points[i].x, y0 = points[i].y;
+            const int32_t x1 = points[j].x, y1 = points[j].y;
+            if ((y0 <= local_y && local_y < y1) ||
+                (y1 <= local_y && local_y < y0)) {
+                /* Vertices can be far outside, so the product needs 64 bits */
+                const int32_t x =
+                  x0 * 256 + (int32_t)(((int64_t)(2 * (local_y - y0) + 1) *
+                                        (x1 - x0) * 256) /
+                                       (2 * (y1 - y0)));
+
+                /* Insertion sort, since there are only a few crossings */
+                size_t k = crossing_count++;
+                for (; k > 0 && crossings[k - 1] > x; k--)
+                    crossings[k] = crossings[k - 1];
+                crossings[k] = x;
+            }
+        }
+
+        for (size_t k = 0; k + 1 < crossing_count; k += 2) {
+            const int32_t x0 = (crossings[k] + 127) >> 8;
+            const int32_t x1 = (crossings[k + 1] + 127) >> 8;
+            epd_2in9_hspan(ctx,
+                           y,
+                           x0 + viewport->origin_x,
+                           x1 + viewport->origin_x,
+                           color);
+        }
+    }
+}
+
+void epd_2in9_draw_bitmap(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t width,
+                          uint16_t height,
+                          const uint8_t* bitmap,
+                          size_t stride,
+                          uint8_t color) {
+    epd_2in9_blit(ctx, x, y, width, height, bitmap, stride, color);
+}
+
+void epd_2in9_draw_bitmap_scaled(const epd_ctx_t* ctx,
+                                 uint16_t x,
+                                 uint16_t y,
+                                 uint16_t width,
+                                 uint16_t height,
+                                 const uint8_t* bitmap,
+                                 size_t stride,
+                                 uint16_t scale_x,
+                                 uint16_t scale_y,
+                                 uint8_t color) {
+    epd_2in9_blit_scaled(ctx,
+                         x,
+                         y,
+                         width,
+                         height,
+                         bitmap,
+                         stride,
+                         scale_x,
+                         scale_y,
+                         color);
+}
+
+void epd_2in9_copy_bitmap(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t width,
+                          uint16_t height,
+                          const uint8_t* bitmap,
+                          size_t stride) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t abs_x            = x + viewport->origin_x;
+    const int32_t abs_y            = y + viewport->origin_y;
+
+    /* Part of the bitmap inside of the clip rectangle, in display coordinates */
+    const int32_t x0 = (abs_x > viewport->clip_x0) ? abs_x : viewport->clip_x0;
+    const int32_t y0 = (abs_y > viewport->clip_y0) ? abs_y : viewport->clip_y0;
+    const int32_t x1 = (abs_x + width < viewport->clip_x1) ? abs_x + width
+                                                           : viewport->clip_x1;
+    const int32_t y1 = (abs_y + height < viewport->clip_y1) ? abs_y + height
+                                                            : viewport->clip_y1;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    const int32_t row_size   = ctx->width / 8;
+    const int32_t src_bytes  = (width + 7) / 8;
+    const int32_t first      = x0 / 8;
+    const int32_t last       = (x1 - 1) / 8;
+    const uint8_t first_mask = 0xFF >> (x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+
+    for (int32_t dst_y = y0; dst_y < y1; dst_y++) {
+        const uint8_t* src = &bitmap[(dst_y - abs_y) * stride];
+        uint8_t* dst       = &ctx->framebuffer[dst_y * row_size];
+
+        int32_t index = first;
+        while (index <= last) {
+            /*
+             * If the bitmap is byte-aligned in the framebuffer, the whole bytes
+             * in the middle of the row are copied at once.
+             */
+            if ((abs_x & 7) == 0 && index > first && index < last) {
+                memcpy(&dst[index], &src[index - abs_x / 8], last - index);
+                index = last;
+                continue;
+            }
+
+            uint8_t mask = 0xFF;
+            if (index == first)
+                mask &= first_mask;
+            if (index == last)
+                mask &= last_mask;
+
+            const uint8_t bits =
+              epd_2in9_source_byte(src, src_bytes, index * 8 - abs_x);
+            dst[index] = (dst[index] & ~mask) | (bits & mask);
+            index++;
+        }
+
+        if (ctx->framebuffer_red != NULL)
+            epd_2in9_fill_plane_span(&ctx->framebuffer_red[dst_y * row_size],
+                                     x0,
+                                     x1,
+                                     PLANE_CLEAR);
+    }
 }
 
 void epd_2in9_draw_char(const epd_ctx_t* ctx,
                         uint16_t x,
                         uint16_t y,
-                        char c,
+                        uint32_t codepoint,
                         uint8_t color) {
-    const uint8_t* glyph = font_get_glyph(c);
-    for (uint8_t glyph_x = 0; glyph_x < FONT_WIDTH; glyph_x++) {
-        const uint8_t line = glyph[col];
-        for (uint8_t glyph_y = 0; glyph_y < FONT_HEIGHT; glyph_y++)
-            if (line & (1 << row))
-                epd_2in9_draw_pixel(ctx, x + glyph_x, y + glyph_y, color);
-    }
+    const epd_font_glyph_t* glyph = font_get_glyph(ctx->font, codepoint);
+    if (glyph == NULL)
+        return;
+
+    epd_2in9_glyph(ctx, x, y, glyph, color);
 }
 
 void epd_2in9_draw_str(const epd_ctx_t* ctx,
@@ -292,9 +1754,21 @@ void epd_2in9_draw_str(const epd_ctx_t* ctx,
                        const char* str,
                        uint8_t color) {
     uint16_t cur_x = x;
-    while (*str != '\0') {
-        epd_2in9_draw_char(ctx, cur_x, y, *str, color);
-        cur_x += 6;
-        str++;
+    uint16_t cur_y = y;
+
+    uint32_t codepoint;
+    while ((codepoint = font_utf8_next(&str)) != 0) {
+        if (codepoint == '\n') {
+            cur_x = x;
+            cur_y += epd_scale_length(ctx->font->line_height, ctx->text_scale);
+            continue;
+        }
+
+        const epd_font_glyph_t* glyph = font_get_glyph(ctx->font, codepoint);
+        if (glyph == NULL)
+            continue;
+
+        epd_2in9_glyph(ctx, cur_x, cur_y, glyph, color);
+        cur_x += epd_scale_length(glyph->advance, ctx->text_scale);
     }
 }
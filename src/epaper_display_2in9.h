@@ -21,27 +21,53 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "epaper_display.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*
- * Initialization function for a 2.9" E-Paper Display.
+ * Initialization steps for a 2.9" E-Paper Display. See the 'epaper_display.h'
+ * header for more information.
  */
-bool epd_2in9_init_display(const epd_ctx_t* ctx);
+enum EEpdInitWait epd_2in9_init_step(const epd_ctx_t* ctx,
+                                     uint8_t step,
+                                     uint32_t* delay_us);
 
 /*
  * Model-specific control functions. See the 'epaper_display.h' header for more
  * information.
  */
 void epd_2in9_reset(const epd_ctx_t* ctx);
-void epd_2in9_flush(const epd_ctx_t* ctx);
+void epd_2in9_flush(const epd_ctx_t* ctx, uint16_t y_start, uint16_t y_end);
 void epd_2in9_sleep(const epd_ctx_t* ctx);
+void epd_2in9_load_frame(const epd_ctx_t* ctx);
+
+/*
+ * Initialization and control functions of the three-color (black, white and
+ * red) variant. The rest of the functions are shared with the monochrome
+ * model, and draw in both planes when the context has a red plane.
+ */
+enum EEpdInitWait epd_2in9_bwr_init_step(const epd_ctx_t* ctx,
+                                         uint8_t step,
+                                         uint32_t* delay_us);
+void epd_2in9_bwr_flush(const epd_ctx_t* ctx,
+                        uint16_t y_start,
+                        uint16_t y_end);
+void epd_2in9_bwr_load_frame(const epd_ctx_t* ctx);
 
 /*
  * Model-specific drawing functions. See the 'epaper_display.h' header for more
  * information.
  */
 void epd_2in9_clear(const epd_ctx_t* ctx, uint8_t color);
+void epd_2in9_scroll(const epd_ctx_t* ctx,
+                     int16_t dx,
+                     int16_t dy,
+                     uint8_t color);
 void epd_2in9_draw_pixel(const epd_ctx_t* ctx, uint16_t x, uint16_t y, uint8_t color);
 void epd_2in9_draw_line(const epd_ctx_t* ctx,
                         uint16_t x0,
@@ -61,10 +87,74 @@ void epd_2in9_draw_filled_rect(const epd_ctx_t* ctx,
                                uint16_t width,
                                uint16_t height,
                                uint8_t color);
+void epd_2in9_draw_circle(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t radius,
+                          uint8_t color);
+void epd_2in9_draw_filled_circle(const epd_ctx_t* ctx,
+                                 uint16_t x,
+                                 uint16_t y,
+                                 uint16_t radius,
+                                 uint8_t color);
+void epd_2in9_draw_arc(const epd_ctx_t* ctx,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t radius,
+                       int16_t start_angle,
+                       int16_t end_angle,
+                       uint8_t color);
+void epd_2in9_draw_round_rect(const epd_ctx_t* ctx,
+                              uint16_t x,
+                              uint16_t y,
+                              uint16_t width,
+                              uint16_t height,
+                              uint16_t radius,
+                              uint8_t color);
+void epd_2in9_draw_filled_round_rect(const epd_ctx_t* ctx,
+                                     uint16_t x,
+                                     uint16_t y,
+                                     uint16_t width,
+                                     uint16_t height,
+                                     uint16_t radius,
+                                     uint8_t color);
+void epd_2in9_draw_polygon(const epd_ctx_t* ctx,
+                           const epd_point_t* points,
+                           size_t count,
+                           uint8_t color);
+void epd_2in9_draw_filled_polygon(const epd_ctx_t* ctx,
+                                  const epd_point_t* points,
+                                  size_t count,
+                                  uint8_t color);
+void epd_2in9_draw_bitmap(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t width,
+                          uint16_t height,
+                          const uint8_t* bitmap,
+                          size_t stride,
+                          uint8_t color);
+void epd_2in9_draw_bitmap_scaled(const epd_ctx_t* ctx,
+                                 uint16_t x,
+                                 uint16_t y,
+                                 uint16_t width,
+                                 uint16_t height,
+                                 const uint8_t* bitmap,
+                                 size_t stride,
+                                 uint16_t scale_x,
+                                 uint16_t scale_y,
+                                 uint8_t color);
+void epd_2in9_copy_bitmap(const epd_ctx_t* ctx,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t width,
+                          uint16_t height,
+                          const uint8_t* bitmap,
+                          size_t stride);
 void epd_2in9_draw_char(const epd_ctx_t* ctx,
                         uint16_t x,
                         uint16_t y,
-                        char c,
+                        uint32_t codepoint,
                         uint8_t color);
 void epd_2in9_draw_str(const epd_ctx_t* ctx,
                        uint16_t x,
@@ -72,4 +162,8 @@ void epd_2in9_draw_str(const epd_ctx_t* ctx,
                        const char* str,
                        uint8_t color);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* EPAPER_DISPLAY_2IN9_H_ */
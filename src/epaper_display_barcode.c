@@ -0,0 +1,971 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_barcode.h"
+
+#include <string.h>
+
+#include "epaper_display_utils.h"
+
+#if EPD_QR_MAX_VERSION < 1 || EPD_QR_MAX_VERSION > 40
+#error "EPD_QR_MAX_VERSION must be between 1 and 40."
+#endif
+
+/* Bytes of a row buffer */
+#define BARCODE_ROW_SIZE (EPD_BARCODE_MAX_WIDTH / 8)
+
+/*
+ * Error correction codewords of each block, and number of blocks, for each
+ * error correction level and QR code version (index 0 is unused).
+ */
+static const uint8_t qr_ecc_per_block[4][41] = {
+    { 0,  7,  10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26,
+      30, 22, 24, 28, 30, 28, 28, 28, 28, 30, 30, 26, 28, 30,
+      30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+    { 0,  10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22,
+      24, 24, 28, 28, 26, 26, 26, 26, 28, 28, 28, 28, 28, 28,
+      28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28 },
+    { 0,  13, 22, 18, 26, 18, 24, 18, 22, 20, 24, 28, 26, 24,
+      20, 30, 24, 28, 28, 26, 30, 28, 30, 30, 30, 30, 28, 30,
+      30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+    { 0,  17, 28, 22, 16, 22, 28, 26, 26, 24, 28, 24, 28, 22,
+      24, 24, 30, 28, 28, 26, 28, 30, 24, 30, 30, 30, 30, 30,
+      30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30 },
+};
+
+static const uint8_t qr_num_blocks[4][41] = {
+    { 0,  1,  1,  1,  1,  1,  2,  2,  2,  2,  4,  4,  4,  4,
+      4,  6,  6,  6,  6,  7,  8,  8,  9,  9,  10, 12, 12, 12,
+      13, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25 },
+    { 0,  1,  1,  1,  2,  2,  4,  4,  4,  5,  5,  5,  8,  9,
+      9,  10, 10, 11, 13, 14, 16, 17, 17, 18, 20, 21, 23, 25,
+      26, 28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49 },
+    { 0,  1,  1,  2,  2,  4,  4,  6,  6,  8,  8,  8,  10, 12,
+      16, 12, 17, 16, 18, 21, 20, 23, 23, 25, 27, 29, 34, 34,
+      35, 38, 40, 43, 45, 48, 51, 53, 56, 59, 62, 65, 68 },
+    { 0,  1,  1,  2,  4,  4,  4,  5,  6,  8,  8,  11, 11, 16,
+      16, 18, 16, 19, 21, 25, 25, 25, 34, 30, 32, 35, 37, 40,
+      42, 45, 48, 51, 54, 57, 60, 63, 66, 70, 74, 77, 81 },
+};
+
+/* Error correction level bits of the format information */
+static const uint8_t qr_ecc_format_bits[4] = { 1, 0, 3, 2 };
+
+/*
+ * Code 128 symbols, with one bit per module (set for bars), and the stop
+ * pattern, which has 13 modules.
+ */
+static const uint16_t code128_patterns[106] = {
+    0x6CC, 0x66C, 0x666, 0x498, 0x48C, 0x44C, 0x4C8, 0x4C4, 0x464, 0x648,
+    0x644, 0x624, 0x59C, 0x4DC, 0x4CE, 0x5CC, 0x4EC, 0x4E6, 0x672, 0x65C,
+    0x64E, 0x6E4, 0x674, 0x76E, 0x74C, 0x72C, 0x726, 0x764, 0x734, 0x732,
+    0x6D8, 0x6C6, 0x636, 0x518, 0x458, 0x446, 0x588, 0x468, 0x462, 0x688,
+    0x628, 0x622, 0x5B8, 0x58E, 0x46E, 0x5D8, 0x5C6, 0x476, 0x776, 0x68E,
+    0x62E, 0x6E8, 0x6E2, 0x6EE, 0x758, 0x746, 0x716, 0x768, 0x762, 0x71A,
+    0x77A, 0x642, 0x78A, 0x530, 0x50C, 0x4B0, 0x486, 0x42C, 0x426, 0x590,
+    0x584, 0x4D0, 0x4C2, 0x434, 0x432, 0x612, 0x650, 0x7BA, 0x614, 0x47A,
+    0x53C, 0x4BC, 0x49E, 0x5E4, 0x4F4, 0x4F2, 0x7A4, 0x794, 0x792, 0x6DE,
+    0x6F6, 0x7B6, 0x578, 0x51E, 0x45E, 0x5E8, 0x5E2, 0x7A8, 0x7A2, 0x5DE,
+    0x5EE, 0x75E, 0x7AE, 0x684, 0x690, 0x69C,
+};
+#define CODE128_STOP 0x18EB
+
+/* Code 128 symbols that select or switch the code set */
+#define CODE128_CODE_C  99
+#define CODE128_CODE_B  100
+#define CODE128_CODE_A  101
+#define CODE128_START_A 103
+
+/*
+ * Left-hand odd (L) patterns of the EAN-13 digits. The even (G) patterns are
+ * the reversed right-hand (R) ones, which are the inverted L patterns.
+ */
+static const uint8_t ean_l_patterns[10] = {
+    0x0D, 0x19, 0x13, 0x3D, 0x23, 0x31, 0x2F, 0x3B, 0x37, 0x0B,
+};
+
+/*
+ * Parity of the digits of the left half, depending on the first digit. Set
+ * bits (from the MSB, for 6 digits) use the G patterns.
+ */
+static const uint8_t ean_parities[10] = {
+    0x00, 0x0B, 0x0D, 0x0E, 0x13, 0x19, 0x1C, 0x15, 0x16, 0x1A,
+};
+
+/*----------------------------------------------------------------------------*/
+/* Row buffers */
+
+/*
+ * Row of pixels being built, with the same layout as a framebuffer row. It
+ * starts white, and modules are appended at the pen position.
+ */
+typedef struct {
+    uint8_t bytes[BARCODE_ROW_SIZE];
+    uint16_t pen;
+} barcode_row_t;
+
+static inline void barcode_row_init(barcode_row_t* row) {
+    memset(row->bytes, 0xFF, sizeof(row->bytes));
+    row->pen = 0;
+}
+
+/*
+ * Make the pixels [x0, x1) of a row black, writing whole bytes in between the
+ * partial ones at both ends.
+ */
+static void barcode_row_dark(barcode_row_t* row, uint16_t x0, uint16_t x1) {
+    const uint16_t first     = x0 / 8;
+    const uint16_t last      = (x1 - 1) / 8;
+    const uint8_t first_mask = 0xFF >> (x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (x1 - 1) % 8);
+
+    if (first == last) {
+        row->bytes[first] &= ~(first_mask & last_mask);
+        return;
+    }
+
+    row->bytes[first] &= ~first_mask;
+    memset(&row->bytes[first + 1], 0x00, last - first - 1);
+    row->bytes[last] &= ~last_mask;
+}
+
+/*
+ * Append 'count' modules of 'scale' pixels, from the most significant of the
+ * lower 'count' bits of 'bits'. Set bits are dark. Consecutive dark modules
+ * are filled as a single span.
+ */
+static void barcode_row_put(barcode_row_t* row,
+                            uint32_t bits,
+                            uint8_t count,
+                            uint8_t scale) {
+    uint16_t run_start = 0;
+    bool in_run        = false;
+
+    for (int i = count - 1; i >= 0; i--) {
+        const bool dark = (bits >> i) & 1;
+        if (dark && !in_run) {
+            run_start = row->pen;
+            in_run    = true;
+        } else if (!dark && in_run) {
+            barcode_row_dark(row, run_start, row->pen);
+            in_run = false;
+        }
+        row->pen += scale;
+    }
+
+    if (in_run)
+        barcode_row_dark(row, run_start, row->pen);
+}
+
+/*
+ * Check that the scale is valid, and that a code of the specified number of
+ * modules fits in a row.
+ */
+static bool barcode_fits(uint32_t modules, uint8_t scale) {
+    if (scale == 0) {
+        EPD_LOG("Invalid barcode scale (0).");
+        return false;
+    }
+
+    if (modules * scale > EPD_BARCODE_MAX_WIDTH) {
+        EPD_LOG("Barcode is too wide (%lu modules at scale %d).",
+                (unsigned long)modules,
+                scale);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Copy a row to 'height' framebuffer rows at once. A stride of zero makes
+ * every row read the same bytes.
+ */
+static inline void barcode_row_draw(const epd_ctx_t* ctx,
+                                    uint16_t x,
+                                    uint16_t y,
+                                    const barcode_row_t* row,
+                                    uint16_t height) {
+    epd_copy_bitmap(ctx, x, y, row->pen, height, row->bytes, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+/* QR code encoding */
+
+/*
+ * Information about the layout of a QR code version, used while encoding.
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t size;
+
+    /* Coordinates of the alignment pattern rows and columns */
+    uint8_t align[7];
+    uint8_t num_align;
+} qr_layout_t;
+
+static inline bool qr_get(const epd_qr_t* qr, int x, int y) {
+    return epd_qr_module(qr, x, y);
+}
+
+static inline void qr_set(epd_qr_t* qr, int x, int y, bool dark) {
+    const size_t index = (size_t)y * qr->size + x;
+    const uint8_t mask = 0x80 >> (index % 8);
+    if (dark)
+        qr->modules[index / 8] |= mask;
+    else
+        qr->modules[index / 8] &= ~mask;
+}
+
+static void qr_layout_init(qr_layout_t* layout, uint8_t version) {
+    layout->version   = version;
+    layout->size      = version * 4 + 17;
+    layout->num_align = 0;
+    if (version == 1)
+        return;
+
+    /* The patterns are evenly spaced from the last one, except the first */
+    const int count = version / 7 + 2;
+    const int step  = (version == 32)
+                        ? 26
+                        : (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+
+    layout->num_align = count;
+    layout->align[0]  = 6;
+    for (int i = count - 1, pos = layout->size - 7; i >= 1; i--, pos -= step)
+        layout->align[i] = pos;
+}
+
+/*
+ * Number of modules of a version that store data (and error correction)
+ * codewords, including the remainder bits.
+ */
+static uint32_t qr_raw_modules(uint8_t version) {
+    uint32_t result = (16 * version + 128) * version + 64;
+    if (version >= 2) {
+        const uint32_t count = version / 7 + 2;
+        result -= (25 * count - 10) * count - 55;
+        if (version >= 7)
+            result -= 36;
+    }
+    return result;
+}
+
+static inline uint32_t qr_data_codewords(uint8_t version, uint8_t ecc) {
+    return qr_raw_modules(version) / 8 -
+           qr_ecc_per_block[ecc][version] * qr_num_blocks[ecc][version];
+}
+
+/*
+ * Check if a module belongs to a function pattern (finder patterns and their
+ * separators, format and version information, timing and alignment patterns),
+ * instead of storing data.
+ */
+static bool qr_is_function(const qr_layout_t* layout, int x, int y) {
+    const int size = layout->size;
+
+    /* Finder patterns, separators and format information */
+    if ((x < 9 && y < 9) || (x >= size - 8 && y < 9) ||
+        (x < 9 && y >= size - 8))
+        return true;
+    if (x == 6 || y == 6)
+        return true;
+    if (layout->version >= 7 &&
+        ((x >= size - 11 && x < size - 8 && y < 6) ||
+         (y >= size - 11 && y < size - 8 && x < 6)))
+        return true;
+
+    const int last = layout->num_align - 1;
+    for (int i = 0; i < layout->num_align; i++) {
+        const int dy = y - layout->align[i];
+        if (dy < -2 || dy > 2)
+            continue;
+
+        for (int j = 0; j < layout->num_align; j++) {
+            /* The corners overlap the finder patterns */
+            if ((i == 0 && j == 0) || (i == 0 && j == last) ||
+                (i == last && j == 0))
+                continue;
+
+            const int dx = x - layout->align[j];
+            if (dx >= -2 && dx <= 2)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+static void qr_draw_finder(epd_qr_t* qr, int cx, int cy) {
+    for (int dy = -4; dy <= 4; dy++) {
+        for (int dx = -4; dx <= 4; dx++) {
+            const int x = cx + dx;
+            const int y = cy + dy;
+            if (x < 0 || y < 0 || x >= qr->size || y >= qr->size)
+                continue;
+
+            /* Chebyshev distance from the center */
+            const int adx  = (dx < 0) ? -dx : dx;
+            const int ady  = (dy < 0) ? -dy : dy;
+            const int dist = (adx > ady) ? adx : ady;
+            qr_set(qr, x, y, dist != 2 && dist != 4);
+        }
+    }
+}
+
+/*
+ * Draw the function patterns, except the format information, which depends
+ * on the mask.
+ */
+static void qr_draw_functions(epd_qr_t* qr, const qr_layout_t* layout) {
+    const int size = layout->size;
+
+    for (int i = 0; i < size; i++) {
+        qr_set(qr, 6, i, i % 2 == 0);
+        qr_set(qr, i, 6, i % 2 == 0);
+    }
+
+    qr_draw_finder(qr, 3, 3);
+    qr_draw_finder(qr, size - 4, 3);
+    qr_draw_finder(qr, 3, size - 4);
+
+    const int last = layout->num_align - 1;
+    for (int i = 0; i < layout->num_align; i++) {
+        for (int j = 0; j < layout->num_align; j++) {
+            if ((i == 0 && j == 0) || (i == 0 && j == last) ||
+                (i == last && j == 0))
+                continue;
+
+            for (int dy = -2; dy <= 2; dy++)
+                for (int dx = -2; dx <= 2; dx++)
+                    qr_set(qr,
+                           layout->align[j] + dx,
+                           layout->align[i] + dy,
+                           dx == -2 || dx == 2 || dy == -2 || dy == 2 ||
+                             (dx == 0 && dy == 0));
+        }
+    }
+
+    /* Version information, with its BCH error correction bits */
+    if (layout->version >= 7) {
+        uint32_t rem = layout->version;
+        for (int i = 0; i < 12; i++)
+            rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+        const uint32_t bits = (uint32_t)layout->version << 12 | rem;
+
+        for (int i = 0; i < 18; i++) {
+            const bool dark = (bits >> i) & 1;
+            const int a     = size - 11 + i % 3;
+            const int b     = i / 3;
+            qr_set(qr, a, b, dark);
+            qr_set(qr, b, a, dark);
+        }
+    }
+}
+
+/*
+ * Draw both copies of the format information, with its BCH error correction
+ * bits, and the dark module next to the bottom-left finder pattern.
+ */
+static void qr_draw_format(epd_qr_t* qr, uint8_t ecc, uint8_t mask) {
+    const int size      = qr->size;
+    const uint32_t data = (uint32_t)qr_ecc_format_bits[ecc] << 3 | mask;
+
+    uint32_t rem = data;
+    for (int i = 0; i < 10; i++)
+        rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+    const uint32_t bits = (data << 10 | rem) ^ 0x5412;
+
+    for (int i = 0; i <= 5; i++)
+        qr_set(qr, 8, i, (bits >> i) & 1);
+    qr_set(qr, 8, 7, (bits >> 6) & 1);
+    qr_set(qr, 8, 8, (bits >> 7) & 1);
+    qr_set(qr, 7, 8, (bits >> 8) & 1);
+    for (int i = 9; i < 15; i++)
+        qr_set(qr, 14 - i, 8, (bits >> i) & 1);
+
+    for (int i = 0; i < 8; i++)
+        qr_set(qr, size - 1 - i, 8, (bits >> i) & 1);
+    for (int i = 8; i < 15; i++)
+        qr_set(qr, 8, size - 15 + i, (bits >> i) & 1);
+    qr_set(qr, 8, size - 8, true);
+}
+
+/*
+ * Multiply two elements of GF(2^8), with the QR code polynomial.
+ */
+static uint8_t qr_gf_mul(uint8_t a, uint8_t b) {
+    uint8_t result = 0;
+    for (int i = 7; i >= 0; i--) {
+        result = (result << 1) ^ ((result >> 7) * 0x11D);
+        result ^= ((b >> i) & 1) * a;
+    }
+    return result;
+}
+
+/*
+ * Compute the Reed-Solomon generator polynomial of the specified degree,
+ * without its leading term, from the highest to the lowest power.
+ */
+static void qr_rs_generator(uint8_t* generator, int degree) {
+    memset(generator, 0, degree);
+    generator[degree - 1] = 1;
+
+    /* Multiply by (x - r^i) for each i, where r = 0x02 */
+    uint8_t root = 1;
+    for (int i = 0; i < degree; i++) {
+        for (int j = 0; j < degree; j++) {
+            generator[j] = qr_gf_mul(generator[j], root);
+            if (j + 1 < degree)
+                generator[j] ^= generator[j + 1];
+        }
+        root = qr_gf_mul(root, 0x02);
+    }
+}
+
+/*
+ * Compute the error correction codewords of a block of data.
+ */
+static void qr_rs_remainder(const uint8_t* data,
+                            int len,
+                            const uint8_t* generator,
+                            int degree,
+                            uint8_t* result) {
+    memset(result, 0, degree);
+    for (int i = 0; i < len; i++) {
+        const uint8_t factor = data[i] ^ result[0];
+        memmove(&result[0], &result[1], degree - 1);
+        result[degree - 1] = 0;
+        for (int j = 0; j < degree; j++)
+            result[j] ^= qr_gf_mul(generator[j], factor);
+    }
+}
+
+/*
+ * Position in the zigzag scan of the data modules, which goes up and down in
+ * two-module columns, from the bottom-right corner.
+ */
+typedef struct {
+    int right; /* Right column of the current pair */
+    int vert;  /* Index of the current row in the scan direction */
+    int col;   /* 0 for the right module, 1 for the left one */
+} qr_cursor_t;
+
+/*
+ * Move the cursor to the next data module. Returns false if there is none.
+ */
+static bool qr_cursor_next(const qr_layout_t* layout,
+                           qr_cursor_t* cursor,
+                           int* x,
+                           int* y) {
+    const int size = layout->size;
+
+    while (cursor->right >= 1) {
+        const bool upward = ((cursor->right + 1) & 2) == 0;
+        *x = cursor->right - cursor->col;
+        *y = upward ? size - 1 - cursor->vert : cursor->vert;
+
+        /* Advance for the next call */
+        if (++cursor->col == 2) {
+            cursor->col = 0;
+            if (++cursor->vert == size) {
+                cursor->vert = 0;
+                cursor->right -= 2;
+                /* Skip the vertical timing pattern */
+                if (cursor->right == 6)
+                    cursor->right = 5;
+            }
+        }
+
+        if (!qr_is_function(layout, *x, *y))
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * Place the codewords in the data modules, interleaving the blocks. Each
+ * buffer holds the data codewords of all blocks, followed by the error
+ * correction codewords of all blocks.
+ */
+static void qr_place_codewords(epd_qr_t* qr,
+                               const qr_layout_t* layout,
+                               const uint8_t* codewords,
+                               uint8_t ecc) {
+    const int version    = layout->version;
+    const int num_blocks = qr_num_blocks[ecc][version];
+    const int ecc_len    = qr_ecc_per_block[ecc][version];
+    const int raw        = qr_raw_modules(version) / 8;
+    const int data_len   = raw - num_blocks * ecc_len;
+
+    /* The first blocks are one codeword shorter than the rest */
+    const int num_short  = num_blocks - raw % num_blocks;
+    const int short_data = raw / num_blocks - ecc_len;
+
+    qr_cursor_t cursor = { layout->size - 1, 0, 0 };
+    int x, y;
+
+    for (int i = 0; i <= short_data; i++) {
+        for (int b = 0; b < num_blocks; b++) {
+            if (i == short_data && b < num_short)
+                continue;
+
+            const int longer = (b > num_short) ? b - num_short : 0;
+            const uint8_t cw = codewords[b * short_data + longer + i];
+            for (int bit = 7; bit >= 0; bit--)
+                if (qr_cursor_next(layout, &cursor, &x, &y))
+                    qr_set(qr, x, y, (cw >> bit) & 1);
+        }
+    }
+
+    for (int i = 0; i < ecc_len; i++) {
+        for (int b = 0; b < num_blocks; b++) {
+            const uint8_t cw = codewords[data_len + b * ecc_len + i];
+            for (int bit = 7; bit >= 0; bit--)
+                if (qr_cursor_next(layout, &cursor, &x, &y))
+                    qr_set(qr, x, y, (cw >> bit) & 1);
+        }
+    }
+
+    /* Remainder bits are light */
+    while (qr_cursor_next(layout, &cursor, &x, &y))
+        qr_set(qr, x, y, false);
+}
+
+static inline bool qr_mask_bit(uint8_t mask, int x, int y) {
+    switch (mask) {
+        case 0:
+            return (x + y) % 2 == 0;
+        case 1:
+            return y % 2 == 0;
+        case 2:
+            return x % 3 == 0;
+        case 3:
+            return (x + y) % 3 == 0;
+        case 4:
+            return (x / 3 + y / 2) % 2 == 0;
+        case 5:
+            return x * y % 2 + x * y % 3 == 0;
+        case 6:
+            return (x * y % 2 + x * y % 3) % 2 == 0;
+        default:
+            return ((x + y) % 2 + x * y % 3) % 2 == 0;
+    }
+}
+
+/*
+ * Toggle the data modules selected by a mask. Applying it twice undoes it.
+ */
+static void qr_apply_mask(epd_qr_t* qr,
+                          const qr_layout_t* layout,
+                          uint8_t mask) {
+    for (int y = 0; y < qr->size; y++)
+        for (int x = 0; x < qr->size; x++)
+            if (qr_mask_bit(mask, x, y) && !qr_is_function(layout, x, y))
+                qr_set(qr, x, y, !qr_get(qr, x, y));
+}
+
+/*
+ * Module of a row (or of a column, if 'vertical' is true), where the ones
+ * outside of the code are light.
+ */
+static inline bool qr_line_get(const epd_qr_t* qr,
+                               bool vertical,
+                               int line,
+                               int i) {
+    if (i < 0 || i >= qr->size)
+        return false;
+    return vertical ? qr_get(qr, line, i) : qr_get(qr, i, line);
+}
+
+/*
+ * Penalty of the runs of modules of the same color, and of the patterns that
+ * look like finder patterns, in a row or column.
+ */
+static uint32_t qr_line_penalty(const epd_qr_t* qr, bool vertical, int line) {
+    uint32_t penalty = 0;
+    const int size   = qr->size;
+
+    int run   = 0;
+    bool prev = false;
+    for (int i = 0; i < size; i++) {
+        const bool dark = qr_line_get(qr, vertical, line, i);
+        if (i > 0 && dark == prev) {
+            run++;
+        } else {
+            if (run >= 5)
+                penalty += run - 2;
+            run  = 1;
+            prev = dark;
+        }
+    }
+    if (run >= 5)
+        penalty += run - 2;
+
+    /* Dark-light-dark-dark-dark-light-dark, with 4 light modules at a side */
+    static const bool pattern[7] = { 1, 0, 1, 1, 1, 0, 1 };
+    for (int i = 0; i + 7 <= size; i++) {
+        bool match = true;
+        for (int j = 0; j < 7 && match; j++)
+            match = qr_line_get(qr, vertical, line, i + j) == pattern[j];
+        if (!match)
+            continue;
+
+        bool before = true, after = true;
+        for (int j = 1; j <= 4; j++) {
+            before = before && !qr_line_get(qr, vertical, line, i - j);
+            after  = after && !qr_line_get(qr, vertical, line, i + 6 + j);
+        }
+        if (before || after)
+            penalty += 40;
+    }
+
+    return penalty;
+}
+
+/*
+ * Penalty of a masked code, lower for codes that are easier to scan.
+ */
+static uint32_t qr_penalty(const epd_qr_t* qr) {
+    const int size   = qr->size;
+    uint32_t penalty = 0;
+    uint32_t dark    = 0;
+
+    for (int i = 0; i < size; i++)
+        penalty += qr_line_penalty(qr, false, i) + qr_line_penalty(qr, true, i);
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const bool color = qr_get(qr, x, y);
+            dark += color;
+
+            /* 2x2 blocks of the same color */
+            if (x + 1 < size && y + 1 < size && qr_get(qr, x + 1, y) == color &&
+                qr_get(qr, x, y + 1) == color &&
+                qr_get(qr, x + 1, y + 1) == color)
+                penalty += 3;
+        }
+    }
+
+    /* Proportion of dark modules, in steps of 5% from 50% */
+    const uint32_t total = size * size;
+    const uint32_t diff  = (dark * 2 > total) ? dark * 2 - total
+                                              : total - dark * 2;
+    penalty += diff * 10 / total * 10;
+
+    return penalty;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool epd_qr_encode(epd_qr_t* qr,
+                   const uint8_t* data,
+                   size_t len,
+                   enum EEpdQrEcc ecc) {
+    /* Find the smallest version that fits the data in byte mode */
+    uint8_t version = 1;
+    uint32_t capacity;
+    for (;; version++) {
+        if (version > EPD_QR_MAX_VERSION) {
+            EPD_LOG("QR code data is too long (%zu bytes).", len);
+            return false;
+        }
+
+        const uint32_t count_bits = (version < 10) ? 8 : 16;
+        capacity                  = qr_data_codewords(version, ecc);
+        if (4 + count_bits + len * 8 <= capacity * 8)
+            break;
+    }
+
+    qr_layout_t layout;
+    qr_layout_init(&layout, version);
+
+    /* Data codewords, followed by the error correction codewords */
+    uint8_t codewords[EPD_QR_BUFFER_SIZE];
+    memset(codewords, 0, sizeof(codewords));
+
+    /* Mode indicator, character count, and the data itself */
+    uint32_t bit          = 0;
+    const int count_bits  = (version < 10) ? 8 : 16;
+    const uint32_t header = (0x4u << count_bits) | len;
+    for (int i = 4 + count_bits - 1; i >= 0; i--, bit++)
+        codewords[bit / 8] |= ((header >> i) & 1) << (7 - bit % 8);
+    for (size_t i = 0; i < len; i++, bit += 8) {
+        codewords[bit / 8] |= data[i] >> (bit % 8);
+        if (bit % 8 != 0)
+            codewords[bit / 8 + 1] |= data[i] << (8 - bit % 8);
+    }
+
+    /* Terminator (at most 4 zero bits), byte alignment, and padding bytes */
+    bit += 4;
+    for (uint32_t i = (bit + 7) / 8, pad = 0xEC; i < capacity; i++) {
+        codewords[i] = pad;
+        pad ^= 0xEC ^ 0x11;
+    }
+
+    /* Error correction codewords of each block */
+    const int num_blocks = qr_num_blocks[ecc][version];
+    const int ecc_len    = qr_ecc_per_block[ecc][version];
+    const int raw        = qr_raw_modules(version) / 8;
+    const int num_short  = num_blocks - raw % num_blocks;
+    const int short_data = raw / num_blocks - ecc_len;
+
+    uint8_t generator[30];
+    qr_rs_generator(generator, ecc_len);
+    for (int b = 0, start = 0; b < num_blocks; b++) {
+        const int block_len = short_data + ((b >= num_short) ? 1 : 0);
+        qr_rs_remainder(&codewords[start],
+                        block_len,
+                        generator,
+                        ecc_len,
+                        &codewords[capacity + b * ecc_len]);
+        start += block_len;
+    }
+
+    qr->version = version;
+    qr->size    = layout.size;
+    memset(qr->modules, 0, sizeof(qr->modules));
+    qr_draw_functions(qr, &layout);
+    qr_place_codewords(qr, &layout, codewords, ecc);
+
+    /* Use the mask that makes the code easiest to scan */
+    uint8_t best_mask     = 0;
+    uint32_t best_penalty = UINT32_MAX;
+    for (uint8_t mask = 0; mask < 8; mask++) {
+        qr_apply_mask(qr, &layout, mask);
+        qr_draw_format(qr, ecc, mask);
+
+        const uint32_t penalty = qr_penalty(qr);
+        if (penalty < best_penalty) {
+            best_penalty = penalty;
+            best_mask    = mask;
+        }
+
+        qr_apply_mask(qr, &layout, mask);
+    }
+
+    qr_apply_mask(qr, &layout, best_mask);
+    qr_draw_format(qr, ecc, best_mask);
+    return true;
+}
+
+bool epd_draw_qr(const epd_ctx_t* ctx,
+                 uint16_t x,
+                 uint16_t y,
+                 const epd_qr_t* qr,
+                 uint8_t scale) {
+    if (!barcode_fits(qr->size, scale))
+        return false;
+
+    barcode_row_t row;
+    for (int my = 0; my < qr->size; my++) {
+        barcode_row_init(&row);
+
+        /* Modules are appended in groups of up to 32 */
+        for (int mx = 0; mx < qr->size; mx += 32) {
+            const int count = (qr->size - mx < 32) ? qr->size - mx : 32;
+            uint32_t bits   = 0;
+            for (int i = 0; i < count; i++)
+                bits = (bits << 1) | qr_get(qr, mx + i, my);
+            barcode_row_put(&row, bits, count, scale);
+        }
+
+        barcode_row_draw(ctx, x, y + my * scale, &row, scale);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/* 1D barcodes */
+
+bool epd_draw_ean13(const epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    const char* digits,
+                    uint8_t scale,
+                    uint16_t height) {
+    uint8_t values[13];
+    size_t len = 0;
+    for (; digits[len] != '\0'; len++) {
+        if (len >= 13 || digits[len] < '0' || digits[len] > '9') {
+            EPD_LOG("Invalid EAN-13 digits: \"%s\".", digits);
+            return false;
+        }
+        values[len] = digits[len] - '0';
+    }
+    if (len < 12) {
+        EPD_LOG("Invalid EAN-13 digits: \"%s\".", digits);
+        return false;
+    }
+
+    /* The digits are weighted 1 and 3 alternately, from the first one */
+    uint32_t sum = 0;
+    for (int i = 0; i < 12; i++)
+        sum += values[i] * ((i % 2 == 0) ? 1 : 3);
+    const uint8_t check = (10 - sum % 10) % 10;
+    if (len == 13 && values[12] != check) {
+        EPD_LOG("Wrong EAN-13 check digit (%d, expected %d).",
+                values[12],
+                check);
+        return false;
+    }
+    values[12] = check;
+
+    if (!barcode_fits(EPD_EAN13_MODULES, scale))
+        return false;
+
+    barcode_row_t row;
+    barcode_row_init(&row);
+
+    /* The first digit is encoded in the parity of the left half */
+    barcode_row_put(&row, 0x5, 3, scale);
+    for (int i = 0; i < 6; i++) {
+        uint8_t pattern = ean_l_patterns[values[i + 1]];
+        if ((ean_parities[values[0]] >> (5 - i)) & 1) {
+            /* G pattern: the reversed complement of the L pattern */
+            uint8_t reversed = 0;
+            for (int j = 0; j < 7; j++)
+                reversed |= ((~pattern >> j) & 1) << (6 - j);
+            pattern = reversed;
+        }
+        barcode_row_put(&row, pattern, 7, scale);
+    }
+    barcode_row_put(&row, 0x0A, 5, scale);
+    for (int i = 7; i < 13; i++)
+        barcode_row_put(&row, ~ean_l_patterns[values[i]] & 0x7F, 7, scale);
+    barcode_row_put(&row, 0x5, 3, scale);
+
+    barcode_row_draw(ctx, x, y, &row, height);
+    return true;
+}
+
+/*
+ * Number of consecutive digits of a string, from its start.
+ */
+static size_t code128_digits(const char* str) {
+    size_t count = 0;
+    while (str[count] >= '0' && str[count] <= '9')
+        count++;
+    return count;
+}
+
+/*
+ * Convert an ASCII string to Code 128 symbols, including the start symbol and
+ * the checksum, but not the stop pattern. Returns the number of symbols, or
+ * zero if the string can't be encoded.
+ */
+static size_t code128_encode(const char* text, uint8_t* symbols) {
+    const size_t len = strlen(text);
+    if (len == 0 || len > EPD_CODE128_MAX_LENGTH)
+        return 0;
+    for (size_t i = 0; i < len; i++)
+        if ((uint8_t)text[i] > 127)
+            return 0;
+
+    size_t count = 0;
+
+    /*
+     * Code set C encodes pairs of digits, and is used for runs of at least 4
+     * digits at the start or end, or 6 in the middle. Set A is used for
+     * control characters, and set B for the rest.
+     */
+    const size_t lead = code128_digits(text);
+    char set;
+    if (lead == len ? lead >= 2 && lead % 2 == 0 : lead >= 4)
+        set = 'C';
+    else if (text[0] < 32)
+        set = 'A';
+    else
+        set = 'B';
+    symbols[count++] = CODE128_START_A + (set - 'A');
+
+    for (size_t i = 0; i < len;) {
+        const char c = text[i];
+
+        if (set == 'C') {
+            if (code128_digits(&text[i]) >= 2) {
+                symbols[count++] = (c - '0') * 10 + (text[i + 1] - '0');
+                i += 2;
+                continue;
+            }
+            set              = (c < 32) ? 'A' : 'B';
+            symbols[count++] = (set == 'A') ? CODE128_CODE_A : CODE128_CODE_B;
+            continue;
+        }
+
+        /* Switch to set C at an even run of digits */
+        const size_t run = code128_digits(&text[i]);
+        if (run % 2 == 0 && (run >= 6 || (run >= 4 && i + run == len))) {
+            set              = 'C';
+            symbols[count++] = CODE128_CODE_C;
+            continue;
+        }
+
+        if (set == 'B' && c < 32) {
+            set              = 'A';
+            symbols[count++] = CODE128_CODE_A;
+        } else if (set == 'A' && c >= 96) {
+            set              = 'B';
+            symbols[count++] = CODE128_CODE_B;
+        }
+
+        symbols[count++] = (c < 32) ? c + 64 : c - 32;
+        i++;
+    }
+
+    /* The checksum weights each symbol by its position */
+    uint32_t sum = symbols[0];
+    for (size_t i = 1; i < count; i++)
+        sum += symbols[i] * i;
+    symbols[count++] = sum % 103;
+
+    return count;
+}
+
+uint16_t epd_code128_modules(const char* text) {
+    uint8_t symbols[EPD_CODE128_MAX_LENGTH * 2 + 2];
+    const size_t count = code128_encode(text, symbols);
+    return (count == 0) ? 0 : count * 11 + 13;
+}
+
+bool epd_draw_code128(const epd_ctx_t* ctx,
+                      uint16_t x,
+                      uint16_t y,
+                      const char* text,
+                      uint8_t scale,
+                      uint16_t height) {
+    uint8_t symbols[EPD_CODE128_MAX_LENGTH * 2 + 2];
+    const size_t count = code128_encode(text, symbols);
+    if (count == 0) {
+        EPD_LOG("Can't encode \"%s\" in Code 128.", text);
+        return false;
+    }
+
+    if (!barcode_fits(count * 11 + 13, scale))
+        return false;
+
+    barcode_row_t row;
+    barcode_row_init(&row);
+    for (size_t i = 0; i < count; i++)
+        barcode_row_put(&row, code128_patterns[symbols[i]], 11, scale);
+    barcode_row_put(&row, CODE128_STOP, 13, scale);
+
+    barcode_row_draw(ctx, x, y, &row, height);
+    return true;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_BARCODE_H_
+#define EPAPER_DISPLAY_BARCODE_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maximum width of a drawn code, in pixels. Each row of modules is built in a
+ * buffer of this size, and copied into the framebuffer at once.
+ */
+#define EPD_BARCODE_MAX_WIDTH 512
+
+/*
+ * Largest QR code version that can be encoded, from 1 to 40. Version N has
+ * 4 * N + 17 modules per side; the default of 10 (57x57 modules) holds up to
+ * 271 bytes with EPD_QR_ECC_L, or 119 with EPD_QR_ECC_H.
+ */
+#ifndef EPD_QR_MAX_VERSION
+#define EPD_QR_MAX_VERSION 10
+#endif
+
+/* Modules per side of the largest QR code, and bytes needed for storing it */
+#define EPD_QR_MAX_SIZE    (EPD_QR_MAX_VERSION * 4 + 17)
+#define EPD_QR_BUFFER_SIZE ((EPD_QR_MAX_SIZE * EPD_QR_MAX_SIZE + 7) / 8)
+
+/*
+ * Number of modules of an EAN-13 barcode, without its quiet zones, which must
+ * be 11 modules at the left, and 7 at the right.
+ */
+#define EPD_EAN13_MODULES 95
+
+/*
+ * Maximum number of characters of a Code 128 barcode.
+ */
+#define EPD_CODE128_MAX_LENGTH 48
+
+/*
+ * Error correction levels of a QR code, from the lowest (about 7% of the code
+ * can be recovered) to the highest (about 30%).
+ */
+enum EEpdQrEcc {
+    EPD_QR_ECC_L,
+    EPD_QR_ECC_M,
+    EPD_QR_ECC_Q,
+    EPD_QR_ECC_H,
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_qr epd_qr_t;
+
+/*
+ * Encoded QR code. Its size is fixed by EPD_QR_MAX_VERSION, so it can be a
+ * static or local variable; encoding it doesn't use the heap, and uses about
+ * EPD_QR_BUFFER_SIZE bytes of stack.
+ */
+struct epd_qr {
+    /* Version of the code, and number of modules per side */
+    uint8_t version;
+    uint8_t size;
+
+    /* Modules in row-major order, one bit each (MSB first), set if dark */
+    uint8_t modules[EPD_QR_BUFFER_SIZE];
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Encode the specified bytes (usually UTF-8 text) in byte mode, with the
+ * smallest QR code version that fits them. Returns false if they don't fit in
+ * EPD_QR_MAX_VERSION with the specified error correction level.
+ */
+bool epd_qr_encode(epd_qr_t* qr,
+                   const uint8_t* data,
+                   size_t len,
+                   enum EEpdQrEcc ecc);
+
+/*
+ * Check if the module at (x, y) of an encoded QR code is dark.
+ */
+static inline bool epd_qr_module(const epd_qr_t* qr, uint8_t x, uint8_t y) {
+    const size_t index = (size_t)y * qr->size + x;
+    return (qr->modules[index / 8] >> (7 - index % 8)) & 1;
+}
+
+/*
+ * Draw an encoded QR code with its top-left corner at (x, y), with each module
+ * as a square of 'scale' pixels. Dark modules are drawn black and light ones
+ * white, replacing the framebuffer content, but the quiet zone (4 modules
+ * around the code) is not drawn. Each row of modules is copied as whole bytes,
+ * and only the bytes at both ends are masked, so the fastest case is an 'x'
+ * that is a multiple of 8.
+ *
+ * Returns false if the code is wider than EPD_BARCODE_MAX_WIDTH pixels.
+ */
+bool epd_draw_qr(const epd_ctx_t* ctx,
+                 uint16_t x,
+                 uint16_t y,
+                 const epd_qr_t* qr,
+                 uint8_t scale);
+
+/*
+ * Draw an EAN-13 barcode with its top-left corner at (x, y), with bars of
+ * 'scale' pixels per module and 'height' pixels tall, like 'epd_draw_qr'.
+ * The 'digits' string must have the 12 digits of the code, or 13 including the
+ * check digit, which is calculated otherwise. The digits are not drawn below
+ * the bars.
+ *
+ * Returns false if the digits are invalid (including a wrong check digit), or
+ * if the barcode is too wide.
+ */
+bool epd_draw_ean13(const epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    const char* digits,
+                    uint8_t scale,
+                    uint16_t height);
+
+/*
+ * Get the number of modules of the Code 128 barcode of an ASCII string,
+ * without its quiet zones, which must be 10 modules at each side. Returns zero
+ * if the string is empty, too long, or has non-ASCII characters.
+ */
+uint16_t epd_code128_modules(const char* text);
+
+/*
+ * Draw a Code 128 barcode of an ASCII string, like 'epd_draw_ean13'. Runs of
+ * digits are encoded in pairs, to make the barcode shorter.
+ *
+ * Returns false if the string can't be encoded, or if the barcode is too wide.
+ */
+bool epd_draw_code128(const epd_ctx_t* ctx,
+                      uint16_t x,
+                      uint16_t y,
+                      const char* text,
+                      uint8_t scale,
+                      uint16_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_BARCODE_H_ */
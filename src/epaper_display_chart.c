@@ -0,0 +1,507 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_chart.h"
+
+#include <string.h>
+
+#include "epaper_display_utils.h"
+
+/*
+ * Sample at the specified position of the plot, from the left.
+ */
+static inline int16_t chart_sample(const epd_chart_t* chart, uint16_t pos) {
+    if (chart->mode == EPD_CHART_SCROLL)
+        return chart->samples[(chart->first + pos) % chart->capacity];
+    return chart->samples[pos];
+}
+
+/*
+ * First column of the specified position, and column of its point.
+ */
+static inline uint16_t chart_block_x(const epd_chart_t* chart, uint16_t pos) {
+    return chart->x + pos * chart->step;
+}
+
+static inline uint16_t chart_point_x(const epd_chart_t* chart, uint16_t pos) {
+    return chart_block_x(chart, pos) + chart->step - 1;
+}
+
+/*
+ * Row of a value, in context coordinates. Values outside of the range are
+ * placed at its limits.
+ */
+static uint16_t chart_value_y(const epd_chart_t* chart, int32_t value) {
+    if (value < chart->range_min)
+        value = chart->range_min;
+    if (value > chart->range_max)
+        value = chart->range_max;
+
+    const int32_t span   = chart->range_max - chart->range_min;
+    const int32_t rows   = chart->height - 1;
+    const int32_t offset =
+      ((value - chart->range_min) * rows + span / 2) / span;
+    return chart->y + rows - offset;
+}
+
+/*
+ * Add the rectangle [x0, x1) x [y0, y1) to the changed one.
+ */
+static void chart_mark(epd_chart_t* chart,
+                       uint16_t x0,
+                       uint16_t y0,
+                       uint16_t x1,
+                       uint16_t y1) {
+    if (!chart->changed) {
+        chart->changed    = true;
+        chart->changed_x0 = x0;
+        chart->changed_y0 = y0;
+        chart->changed_x1 = x1;
+        chart->changed_y1 = y1;
+        return;
+    }
+
+    if (x0 < chart->changed_x0)
+        chart->changed_x0 = x0;
+    if (y0 < chart->changed_y0)
+        chart->changed_y0 = y0;
+    if (x1 > chart->changed_x1)
+        chart->changed_x1 = x1;
+    if (y1 > chart->changed_y1)
+        chart->changed_y1 = y1;
+}
+
+/*
+ * Add the columns [x0, x1) of the rows where the values between 'low' and
+ * 'high' are drawn to the changed rectangle. In the area style, the rows down
+ * to the bottom of the plot are added too.
+ */
+static void chart_mark_values(epd_chart_t* chart,
+                              uint16_t x0,
+                              uint16_t x1,
+                              int32_t low,
+                              int32_t high) {
+    const uint16_t bottom = (chart->style == EPD_CHART_AREA)
+                              ? chart->y + chart->height
+                              : chart_value_y(chart, low) + 1;
+    chart_mark(chart, x0, chart_value_y(chart, high), x1, bottom);
+}
+
+/*
+ * Draw the sample at the specified position, connected to the previous one if
+ * 'has_prev' is true.
+ */
+static void chart_draw(const epd_chart_t* chart,
+                       uint16_t pos,
+                       bool has_prev,
+                       int16_t prev,
+                       int16_t value) {
+    const uint16_t x = chart_point_x(chart, pos);
+    const uint16_t y = chart_value_y(chart, value);
+
+    if (chart->style == EPD_CHART_AREA) {
+        epd_draw_filled_rect(chart->ctx,
+                             chart_block_x(chart, pos),
+                             y,
+                             chart->step,
+                             chart->y + chart->height - y,
+                             chart->color);
+        return;
+    }
+
+    if (has_prev)
+        epd_draw_line(chart->ctx,
+                      x - chart->step,
+                      chart_value_y(chart, prev),
+                      x,
+                      y,
+                      chart->color);
+    else
+        epd_draw_line(chart->ctx,
+                      chart_block_x(chart, pos),
+                      y,
+                      x,
+                      y,
+                      chart->color);
+}
+
+/*
+ * Fill the columns of the specified position with the background color.
+ */
+static void chart_erase(const epd_chart_t* chart, uint16_t pos) {
+    epd_draw_filled_rect(chart->ctx,
+                         chart_block_x(chart, pos),
+                         chart->y,
+                         chart->step,
+                         chart->height,
+                         chart->background);
+}
+
+/*
+ * Update the smallest and largest visible samples after adding 'value', and
+ * removing 'removed' if 'has_removed' is true. They are only searched again
+ * if one of them was removed.
+ */
+static void chart_update_bounds(epd_chart_t* chart,
+                                int16_t value,
+                                bool has_removed,
+                                int16_t removed) {
+    if (chart->count == 1) {
+        chart->data_min = value;
+        chart->data_max = value;
+        return;
+    }
+
+    if (has_removed &&
+        (removed == chart->data_min || removed == chart->data_max)) {
+        chart->data_min = value;
+        chart->data_max = value;
+        for (uint16_t pos = 0; pos < chart->count; pos++) {
+            const int16_t sample = chart_sample(chart, pos);
+            if (sample < chart->data_min)
+                chart->data_min = sample;
+            if (sample > chart->data_max)
+                chart->data_max = sample;
+        }
+        return;
+    }
+
+    if (value < chart->data_min)
+        chart->data_min = value;
+    if (value > chart->data_max)
+        chart->data_max = value;
+}
+
+/*
+ * Round a value down to a multiple of 'multiple', which must be positive.
+ */
+static inline int32_t chart_floor(int32_t value, int32_t multiple) {
+    if (value >= 0)
+        return value / multiple * multiple;
+    return -((-value + multiple - 1) / multiple) * multiple;
+}
+
+/*
+ * Set the range from the visible samples, if autoscaling is enabled. Returns
+ * true if the range changed.
+ */
+static bool chart_autoscale(epd_chart_t* chart) {
+    if (chart->autoscale == 0 || chart->count == 0)
+        return false;
+
+    const int32_t multiple = chart->autoscale;
+    const int32_t min      = chart_floor(chart->data_min, multiple);
+    int32_t max            = -chart_floor(-(int32_t)chart->data_max, multiple);
+    if (max <= min)
+        max = min + multiple;
+
+    if (min == chart->range_min && max == chart->range_max)
+        return false;
+
+    chart->range_min = min;
+    chart->range_max = max;
+    return true;
+}
+
+/*
+ * Draw the last sample in scroll mode. If the plot was full, it's scrolled
+ * first; only the rows of the values that were and are visible are moved,
+ * since the rest only contain the background.
+ */
+static void chart_push_scroll(epd_chart_t* chart,
+                              bool scrolled,
+                              int16_t old_min,
+                              int16_t old_max) {
+    const uint16_t pos  = chart->count - 1;
+    const int16_t value = chart_sample(chart, pos);
+    const int16_t prev  = (pos > 0) ? chart_sample(chart, pos - 1) : value;
+
+    if (!scrolled) {
+        chart_draw(chart, pos, pos > 0, prev, value);
+        chart_mark_values(chart,
+                          (pos > 0) ? chart_point_x(chart, pos - 1)
+                                    : chart_block_x(chart, pos),
+                          chart_block_x(chart, pos + 1),
+                          (prev < value) ? prev : value,
+                          (prev > value) ? prev : value);
+        return;
+    }
+
+    const int16_t low =
+      (old_min < chart->data_min) ? old_min : chart->data_min;
+    const int16_t high =
+      (old_max > chart->data_max) ? old_max : chart->data_max;
+    const uint16_t top = chart_value_y(chart, high);
+    const uint16_t end = (chart->style == EPD_CHART_AREA)
+                           ? chart->y + chart->height
+                           : chart_value_y(chart, low) + 1;
+    const uint16_t used = chart->capacity * chart->step;
+
+    if (!epd_push_clip(chart->ctx, chart->x, top, used, end - top)) {
+        epd_chart_redraw(chart);
+        return;
+    }
+    epd_scroll(chart->ctx, -chart->step, 0, chart->background);
+    epd_pop_viewport(chart->ctx);
+
+    /*
+     * The first position still has the line from the sample that was removed,
+     * so it's drawn again as the start of the chart.
+     */
+    if (chart->style == EPD_CHART_LINE && pos > 0) {
+        const int16_t first = chart_sample(chart, 0);
+        chart_erase(chart, 0);
+        chart_draw(chart, 0, false, first, first);
+        if (pos > 1)
+            chart_draw(chart, 1, true, first, chart_sample(chart, 1));
+    }
+
+    chart_draw(chart, pos, pos > 0, prev, value);
+    chart_mark(chart, chart->x, top, chart->x + used, end);
+}
+
+/*
+ * Draw a sample in sweep mode, at the position before the cursor. The old
+ * samples of the position and of both of its neighbors are needed for finding
+ * the rows that were erased, since their lines are drawn into it.
+ */
+static void chart_push_sweep(epd_chart_t* chart,
+                             bool replaced,
+                             int16_t old_value,
+                             bool has_old_prev,
+                             int16_t old_prev) {
+    const uint16_t pos  = (chart->cursor + chart->capacity - 1) %
+                         chart->capacity;
+    const int16_t value = chart->samples[pos];
+    const int16_t prev  = (pos > 0) ? chart->samples[pos - 1] : value;
+
+    chart_erase(chart, pos);
+    chart_draw(chart, pos, pos > 0, prev, value);
+
+    int16_t low  = value;
+    int16_t high = value;
+#define CHART_INCLUDE(V)                                                       \
+    do {                                                                       \
+        if ((V) < low)                                                         \
+            low = (V);                                                         \
+        if ((V) > high)                                                        \
+            high = (V);                                                        \
+    } while (0)
+
+    if (replaced)
+        CHART_INCLUDE(old_value);
+
+    if (chart->style == EPD_CHART_LINE) {
+        CHART_INCLUDE(prev);
+        if (has_old_prev)
+            CHART_INCLUDE(old_prev);
+        if (replaced && pos + 1 < chart->count)
+            CHART_INCLUDE(chart->samples[pos + 1]);
+    }
+
+#undef CHART_INCLUDE
+
+    const uint16_t x0 = (pos > 0 && chart->style == EPD_CHART_LINE)
+                          ? chart_point_x(chart, pos - 1)
+                          : chart_block_x(chart, pos);
+    chart_mark_values(chart, x0, chart_block_x(chart, pos + 1), low, high);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool epd_chart_init(epd_chart_t* chart,
+                    epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    uint16_t width,
+                    uint16_t height,
+                    uint8_t step,
+                    enum EEpdChartModes mode,
+                    enum EEpdChartStyles style) {
+    if (width == 0 || height == 0 || step == 0 || width < step) {
+        EPD_LOG("The plot area of the chart is empty.");
+        return false;
+    }
+
+    if (width / step > EPD_CHART_MAX_SAMPLES) {
+        EPD_LOG("The chart has more than %d samples.", EPD_CHART_MAX_SAMPLES);
+        return false;
+    }
+
+    memset(chart, 0, sizeof(epd_chart_t));
+    chart->ctx        = ctx;
+    chart->x          = x;
+    chart->y          = y;
+    chart->width      = width;
+    chart->height     = height;
+    chart->step       = step;
+    chart->mode       = mode;
+    chart->style      = style;
+    chart->color      = EPD_COLOR_BLACK;
+    chart->background = EPD_COLOR_WHITE;
+    chart->range_min  = 0;
+    chart->range_max  = (height > 1) ? height - 1 : 1;
+    chart->capacity   = width / step;
+
+    epd_chart_clear(chart);
+    return true;
+}
+
+void epd_chart_set_colors(epd_chart_t* chart,
+                          uint8_t color,
+                          uint8_t background) {
+    if (color == EPD_COLOR_INVERT || background == EPD_COLOR_INVERT) {
+        EPD_LOG("Charts can't be drawn with EPD_COLOR_INVERT.");
+        return;
+    }
+
+    chart->color      = color;
+    chart->background = background;
+    epd_chart_redraw(chart);
+}
+
+void epd_chart_set_range(epd_chart_t* chart, int32_t min, int32_t max) {
+    if (min >= max) {
+        EPD_LOG("Invalid chart range (%ld, %ld).", (long)min, (long)max);
+        return;
+    }
+
+    chart->autoscale = 0;
+    if (min == chart->range_min && max == chart->range_max)
+        return;
+
+    chart->range_min = min;
+    chart->range_max = max;
+    epd_chart_redraw(chart);
+}
+
+void epd_chart_set_autoscale(epd_chart_t* chart, uint16_t multiple) {
+    chart->autoscale = multiple;
+    if (chart_autoscale(chart))
+        epd_chart_redraw(chart);
+}
+
+bool epd_chart_push(epd_chart_t* chart, int16_t value) {
+    const int16_t old_min = chart->data_min;
+    const int16_t old_max = chart->data_max;
+
+    bool removed     = false;
+    int16_t old      = 0;
+    bool scrolled    = false;
+    bool has_prev    = false;
+    int16_t old_prev = 0;
+
+    if (chart->mode == EPD_CHART_SCROLL) {
+        if (chart->count == chart->capacity) {
+            removed      = true;
+            scrolled     = true;
+            old          = chart->samples[chart->first];
+            chart->first = (chart->first + 1) % chart->capacity;
+            chart->count--;
+        }
+        chart->samples[(chart->first + chart->count) % chart->capacity] = value;
+        chart->count++;
+    } else {
+        const uint16_t pos = chart->cursor;
+        if (pos < chart->count) {
+            removed = true;
+            old     = chart->samples[pos];
+        } else {
+            chart->count++;
+        }
+
+        /* The replaced sample of the previous position, if any */
+        has_prev = pos > 0 && chart->replaced_valid;
+        old_prev = chart->replaced;
+
+        chart->samples[pos]   = value;
+        chart->replaced       = old;
+        chart->replaced_valid = removed;
+        chart->cursor         = (pos + 1) % chart->capacity;
+    }
+
+    chart_update_bounds(chart, value, removed, old);
+    if (chart_autoscale(chart)) {
+        epd_chart_redraw(chart);
+        return true;
+    }
+
+    if (chart->mode == EPD_CHART_SCROLL)
+        chart_push_scroll(chart, scrolled, old_min, old_max);
+    else
+        chart_push_sweep(chart, removed, old, has_prev, old_prev);
+
+    return false;
+}
+
+void epd_chart_clear(epd_chart_t* chart) {
+    chart->first          = 0;
+    chart->count          = 0;
+    chart->cursor         = 0;
+    chart->replaced_valid = false;
+    chart->data_min       = 0;
+    chart->data_max       = 0;
+    epd_chart_redraw(chart);
+}
+
+void epd_chart_redraw(epd_chart_t* chart) {
+    epd_draw_filled_rect(chart->ctx,
+                         chart->x,
+                         chart->y,
+                         chart->width,
+                         chart->height,
+                         chart->background);
+
+    /*
+     * In sweep mode, the newest sample is not connected to the oldest one,
+     * which follows it.
+     */
+    const bool wrapped =
+      chart->mode == EPD_CHART_SWEEP && chart->count == chart->capacity;
+    for (uint16_t pos = 0; pos < chart->count; pos++) {
+        const bool has_prev = pos > 0 && !(wrapped && pos == chart->cursor);
+        chart_draw(chart,
+                   pos,
+                   has_prev,
+                   has_prev ? chart_sample(chart, pos - 1) : 0,
+                   chart_sample(chart, pos));
+    }
+
+    chart_mark(chart,
+               chart->x,
+               chart->y,
+               chart->x + chart->width,
+               chart->y + chart->height);
+}
+
+bool epd_chart_take_changed(epd_chart_t* chart,
+                            uint16_t* x,
+                            uint16_t* y,
+                            uint16_t* width,
+                            uint16_t* height) {
+    if (!chart->changed)
+        return false;
+
+    *x      = chart->changed_x0;
+    *y      = chart->changed_y0;
+    *width  = chart->changed_x1 - chart->changed_x0;
+    *height = chart->changed_y1 - chart->changed_y0;
+
+    chart->changed = false;
+    return true;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_CHART_H_
+#define EPAPER_DISPLAY_CHART_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maximum number of samples shown by a chart, which is the width of its plot
+ * area divided by the width of each sample. Can be overridden at compile time.
+ */
+#ifndef EPD_CHART_MAX_SAMPLES
+#define EPD_CHART_MAX_SAMPLES 296
+#endif
+
+/*
+ * How a chart makes room for new samples once its plot area is full.
+ */
+enum EEpdChartModes {
+    /*
+     * The plot is scrolled to the left, and the newest sample is drawn at the
+     * right. Only the rows covered by the samples are scrolled.
+     */
+    EPD_CHART_SCROLL,
+
+    /*
+     * The newest sample replaces the oldest one, at a position that sweeps
+     * the plot from left to right, like in an oscilloscope. Each sample only
+     * erases and draws its own columns, and changes the rows of the old and
+     * new values.
+     */
+    EPD_CHART_SWEEP,
+};
+
+/*
+ * How the samples of a chart are drawn.
+ */
+enum EEpdChartStyles {
+    EPD_CHART_LINE, /* Line between consecutive samples */
+    EPD_CHART_AREA, /* Area between each sample and the bottom of the plot */
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_chart epd_chart_t;
+
+/*
+ * Chart of the latest samples of a value, drawn incrementally. Each new sample
+ * only draws its own columns, and the rectangle that changed since it was last
+ * requested can be flushed alone. All members are private.
+ */
+struct epd_chart {
+    epd_ctx_t* ctx;
+
+    /* Plot area, in context coordinates, and width of each sample in pixels */
+    uint16_t x, y, width, height;
+    uint8_t step;
+
+    enum EEpdChartModes mode;
+    enum EEpdChartStyles style;
+    uint8_t color, background;
+
+    /*
+     * Values at the bottom and top of the plot, and the multiple to which they
+     * are rounded when autoscaling, or zero if the range is fixed.
+     */
+    int32_t range_min, range_max;
+    uint16_t autoscale;
+
+    /*
+     * Ring buffer of the visible samples. In scroll mode, the oldest one is at
+     * 'first'; in sweep mode, each sample is stored at the index of its
+     * position, and 'cursor' is the position of the next one.
+     */
+    int16_t samples[EPD_CHART_MAX_SAMPLES];
+    uint16_t capacity, first, count;
+    uint16_t cursor;
+
+    /*
+     * Previous value of the position before the cursor, which was replaced by
+     * the last sample in sweep mode. Its line is still drawn into the position
+     * of the cursor.
+     */
+    int16_t replaced;
+    bool replaced_valid;
+
+    /* Smallest and largest visible samples */
+    int16_t data_min, data_max;
+
+    /* Rectangle [x0, x1) x [y0, y1) that changed, in context coordinates */
+    bool changed;
+    uint16_t changed_x0, changed_y0, changed_x1, changed_y1;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Initialize an empty chart with the specified plot area, in context
+ * coordinates, and 'step' pixels per sample. The plot area is filled with the
+ * background color, which is white by default, and samples are drawn in
+ * black. The range starts as one value per pixel, from zero.
+ *
+ * Returns false if the plot area is empty, or if it holds more than
+ * EPD_CHART_MAX_SAMPLES samples.
+ */
+bool epd_chart_init(epd_chart_t* chart,
+                    epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    uint16_t width,
+                    uint16_t height,
+                    uint8_t step,
+                    enum EEpdChartModes mode,
+                    enum EEpdChartStyles style);
+
+/*
+ * Set the colors of the samples and of the background, and redraw the chart.
+ * Neither of them can be EPD_COLOR_INVERT.
+ */
+void epd_chart_set_colors(epd_chart_t* chart,
+                          uint8_t color,
+                          uint8_t background);
+
+/*
+ * Set the values at the bottom and top of the plot, and disable autoscaling.
+ * Samples outside of the range are drawn at its limits. The chart is only
+ * redrawn if the range changed.
+ */
+void epd_chart_set_range(epd_chart_t* chart, int32_t min, int32_t max);
+
+/*
+ * Make the range follow the smallest and largest visible samples, rounded
+ * outwards to a multiple of 'multiple', or disable it if 'multiple' is zero.
+ * The chart is only redrawn when the rounded range changes, so larger
+ * multiples redraw it less often.
+ */
+void epd_chart_set_autoscale(epd_chart_t* chart, uint16_t multiple);
+
+/*
+ * Get the current range of the chart, for drawing its axis labels.
+ */
+static inline void epd_chart_get_range(const epd_chart_t* chart,
+                                       int32_t* min,
+                                       int32_t* max) {
+    *min = chart->range_min;
+    *max = chart->range_max;
+}
+
+/*
+ * Add a sample to the chart, and draw it. Returns true if the range changed
+ * with autoscaling, so the whole chart was redrawn.
+ *
+ * Unless the whole chart is redrawn, drawing a sample in sweep mode costs
+ * O(height). In scroll mode, the rows covered by the samples are also
+ * scrolled, which moves whole bytes.
+ */
+bool epd_chart_push(epd_chart_t* chart, int16_t value);
+
+/*
+ * Remove all samples, and fill the plot area with the background color.
+ */
+void epd_chart_clear(epd_chart_t* chart);
+
+/*
+ * Fill the plot area with the background color, and draw all the samples
+ * again. Must be called if something else was drawn over the plot area.
+ */
+void epd_chart_redraw(epd_chart_t* chart);
+
+/*
+ * Get the rectangle that changed since the last call, in context coordinates,
+ * and forget it. Returns false if nothing changed. The rectangle can be passed
+ * to 'epd_sched_request'.
+ */
+bool epd_chart_take_changed(epd_chart_t* chart,
+                            uint16_t* x,
+                            uint16_t* y,
+                            uint16_t* width,
+                            uint16_t* height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_CHART_H_ */
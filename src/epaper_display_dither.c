@@ -0,0 +1,312 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_dither.h"
+
+#include <stdlib.h>
+
+#include "epaper_display_utils.h"
+
+/*
+ * Gray levels are converted to fixed point with 4 fractional bits before adding
+ * the diffused error, so the error fractions are not lost between pixels.
+ */
+#define FIXED_SHIFT 4
+#define TO_FIXED(N) ((int16_t)((N) << FIXED_SHIFT))
+
+/*
+ * 8x8 Bayer threshold matrix, with values in the [0..63] range.
+ */
+static const uint8_t bayer_matrix[8][8] = {
+    { 0, 32, 8, 40, 2, 34, 10, 42 },  { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44, 4, 36, 14, 46, 6, 38 }, { 60, 28, 52, 20, 62, 30, 54, 22 },
+    { 3, 35, 11, 43, 1, 33, 9, 41 },  { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47, 7, 39, 13, 45, 5, 37 }, { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+/*
+ * Helper for packing the output pixels of a row into framebuffer bytes. The
+ * bits are accumulated in 'bits' and written once per byte, keeping the
+ * framebuffer bits that are outside of 'mask' intact. If 'red' is not NULL, the
+ * same bits are cleared in the red plane.
+ */
+typedef struct {
+    uint8_t* byte;
+    uint8_t* red;
+    uint8_t bit;
+    uint8_t bits;
+    uint8_t mask;
+} packer_t;
+
+static inline void packer_put(packer_t* packer, bool white) {
+    if (white)
+        packer->bits |= packer->bit;
+    packer->mask |= packer->bit;
+
+    packer->bit >>= 1;
+    if (packer->bit == 0) {
+        *packer->byte = (*packer->byte & ~packer->mask) | packer->bits;
+        packer->byte++;
+        if (packer->red != NULL)
+            *packer->red++ &= ~packer->mask;
+        packer->bit  = 0x80;
+        packer->bits = 0;
+        packer->mask = 0;
+    }
+}
+
+static inline void packer_finish(packer_t* packer) {
+    if (packer->mask == 0)
+        return;
+
+    *packer->byte = (*packer->byte & ~packer->mask) | packer->bits;
+    if (packer->red != NULL)
+        *packer->red &= ~packer->mask;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void dither_row_threshold(const uint8_t* gray,
+                                 uint16_t first,
+                                 uint16_t end,
+                                 packer_t* packer) {
+    for (uint16_t i = first; i < end; i++)
+        packer_put(packer, gray[i] >= 128);
+}
+
+static void dither_row_bayer(const uint8_t* gray,
+                             int32_t x,
+                             int32_t y,
+                             uint16_t first,
+                             uint16_t end,
+                             packer_t* packer) {
+    /*
+     * The matrix is indexed with display coordinates, so adjacent images share
+     * the same pattern.
+     */
+    const uint8_t* matrix_row = bayer_matrix[y & 7];
+    for (uint16_t i = first; i < end; i++) {
+        const uint8_t threshold = (matrix_row[(x + i) & 7] << 2) + 2;
+        packer_put(packer, gray[i] >= threshold);
+    }
+}
+
+/*
+ * Floyd-Steinberg error diffusion, spreading the error of each pixel with the
+ * following weights (in sixteenths):
+ *
+ *         [ * ] [ 7 ]
+ *   [ 3 ] [ 5 ] [ 1 ]
+ *
+ * A single error row is used for both the current and the next image row:
+ * entries to the left of the current pixel belong to the next row, and the
+ * rest to the current one. The "1/16" part can't be stored until the next
+ * pixel has read its entry, so it's kept in 'pending'.
+ */
+static void dither_row_floyd_steinberg(int16_t* err,
+                                       const uint8_t* gray,
+                                       uint16_t width,
+                                       uint16_t first,
+                                       uint16_t end,
+                                       packer_t* packer) {
+    int16_t right   = 0;
+    int16_t pending = 0;
+
+    for (uint16_t i = 0; i < width; i++) {
+        const int16_t value = TO_FIXED(gray[i]) + err[i] + right;
+        const bool white    = value >= TO_FIXED(128);
+        const int16_t error = value - (white ? TO_FIXED(255) : 0);
+
+        right = (error * 7) >> 4;
+        err[i - 1] += (error * 3) >> 4;
+        err[i]  = pending + ((error * 5) >> 4);
+        pending = error >> 4;
+
+        if (i >= first && i < end)
+            packer_put(packer, white);
+    }
+
+    /* Errors that fell at the left of the image are discarded */
+    err[-1] = 0;
+}
+
+/*
+ * Atkinson error diffusion, spreading 3/4 of the error of each pixel with the
+ * following weights (in eighths):
+ *
+ *         [ * ] [ 1 ] [ 1 ]
+ *   [ 1 ] [ 1 ] [ 1 ]
+ *         [ 1 ]
+ *
+ * The first error row works like in 'dither_row_floyd_steinberg'. The second
+ * row holds the errors that go two rows below; each entry is moved to the
+ * first row once the current pixel has read it.
+ */
+static void dither_row_atkinson(int16_t* err,
+                                int16_t* err_after,
+                                const uint8_t* gray,
+                                uint16_t width,
+                                uint16_t first,
+                                uint16_t end,
+                                packer_t* packer) {
+    int16_t right       = 0;
+    int16_t right_right = 0;
+    int16_t pending     = 0;
+
+    for (uint16_t i = 0; i < width; i++) {
+        const int16_t value = TO_FIXED(gray[i]) + err[i] + right;
+        const bool white    = value >= TO_FIXED(128);
+        const int16_t error = value - (white ? TO_FIXED(255) : 0);
+        const int16_t part  = error >> 3;
+
+        right       = right_right + part;
+        right_right = part;
+
+        err[i - 1] += part;
+        err[i]       = err_after[i] + pending + part;
+        err_after[i] = part;
+        pending      = part;
+
+        if (i >= first && i < end)
+            packer_put(packer, white);
+    }
+
+    err[-1] = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool epd_dither_begin(epd_dither_t* dither,
+                      const epd_ctx_t* ctx,
+                      enum EEpdDitherMethods method,
+                      uint16_t x,
+                      uint16_t y,
+                      uint16_t width) {
+    dither->ctx       = ctx;
+    dither->method    = method;
+    dither->x         = x;
+    dither->y         = y;
+    dither->width     = width;
+    dither->err_next  = NULL;
+    dither->err_after = NULL;
+
+    switch (method) {
+        case EPD_DITHER_THRESHOLD:
+        case EPD_DITHER_BAYER:
+            break;
+
+        case EPD_DITHER_ATKINSON:
+            dither->err_after = calloc(width, sizeof(int16_t));
+            if (dither->err_after == NULL)
+                return false;
+            /* fallthrough */
+
+        case EPD_DITHER_FLOYD_STEINBERG:
+            dither->err_next = calloc(width + 2, sizeof(int16_t));
+            if (dither->err_next == NULL) {
+                free(dither->err_after);
+                dither->err_after = NULL;
+                return false;
+            }
+            break;
+
+        default:
+            EPD_LOG("Invalid dithering method (%d).", method);
+            return false;
+    }
+
+    return true;
+}
+
+void epd_dither_row(epd_dither_t* dither, const uint8_t* gray) {
+    const epd_ctx_t* ctx = dither->ctx;
+
+    /*
+     * Range of pixels of this row that are inside of the clip rectangle. The
+     * rest still have to be processed by the diffusion methods, since their
+     * error affects the visible pixels of the next row.
+     */
+    const epd_viewport_t* viewport = &ctx->viewport;
+    const int32_t abs_x            = dither->x + viewport->origin_x;
+    const int32_t abs_y            = dither->y + viewport->origin_y;
+
+    uint16_t first = 0;
+    uint16_t end   = 0;
+    if (abs_y >= viewport->clip_y0 && abs_y < viewport->clip_y1) {
+        const int32_t clip_first = viewport->clip_x0 - abs_x;
+        const int32_t clip_end   = viewport->clip_x1 - abs_x;
+        first = (clip_first > 0) ? clip_first : 0;
+        end   = (clip_end < dither->width) ? clip_end : dither->width;
+        if (clip_end <= 0 || first >= end)
+            first = end = 0;
+    }
+
+    packer_t packer = {
+        .byte = ctx->framebuffer,
+        .red  = NULL,
+        .bit  = 0x80,
+        .bits = 0,
+        .mask = 0,
+    };
+    if (first < end) {
+        const size_t offset = abs_y * (ctx->width / 8) + (abs_x + first) / 8;
+        packer.byte += offset;
+        if (ctx->framebuffer_red != NULL)
+            packer.red = &ctx->framebuffer_red[offset];
+        packer.bit >>= (abs_x + first) % 8;
+    }
+
+    switch (dither->method) {
+        case EPD_DITHER_THRESHOLD:
+            dither_row_threshold(gray, first, end, &packer);
+            break;
+
+        case EPD_DITHER_BAYER:
+            dither_row_bayer(gray, abs_x, abs_y, first, end, &packer);
+            break;
+
+        case EPD_DITHER_FLOYD_STEINBERG:
+            dither_row_floyd_steinberg(&dither->err_next[1],
+                                       gray,
+                                       dither->width,
+                                       first,
+                                       end,
+                                       &packer);
+            break;
+
+        case EPD_DITHER_ATKINSON:
+            dither_row_atkinson(&dither->err_next[1],
+                                dither->err_after,
+                                gray,
+                                dither->width,
+                                first,
+                                end,
+                                &packer);
+            break;
+    }
+
+    packer_finish(&packer);
+    dither->y++;
+}
+
+void epd_dither_end(epd_dither_t* dither) {
+    free(dither->err_next);
+    free(dither->err_after);
+    dither->err_next  = NULL;
+    dither->err_after = NULL;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_DITHER_H_
+#define EPAPER_DISPLAY_DITHER_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Methods for converting 8-bit grayscale pixels into the 1bpp framebuffer.
+ */
+enum EEpdDitherMethods {
+    EPD_DITHER_THRESHOLD,       /* Fixed threshold at the middle gray */
+    EPD_DITHER_BAYER,           /* Ordered dithering with an 8x8 Bayer matrix */
+    EPD_DITHER_FLOYD_STEINBERG, /* Error diffusion, one error row */
+    EPD_DITHER_ATKINSON,        /* Error diffusion, two error rows */
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_dither epd_dither_t;
+
+/*
+ * State of a streaming dithering operation. The source image is received one
+ * row at a time, so the memory used is proportional to the width of the image,
+ * not to its size.
+ */
+struct epd_dither {
+    /* Context whose framebuffer receives the dithered rows */
+    const epd_ctx_t* ctx;
+
+    /* Selected dithering method */
+    enum EEpdDitherMethods method;
+
+    /*
+     * Position of the next row in context coordinates, and width of each row,
+     * in pixels. The 'y' member is incremented after each call to
+     * 'epd_dither_row'.
+     */
+    uint16_t x, y;
+    uint16_t width;
+
+    /*
+     * Error rows used by the diffusion methods, in 1/16 gray level units. The
+     * first one has 'width + 2' entries, so the first and last pixels of a row
+     * can spread their error without bound checks; the second one is only
+     * allocated for the Atkinson method, which reaches two rows below.
+     */
+    int16_t* err_next;
+    int16_t* err_after;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Start a dithering operation whose top-left corner will be placed at (x, y)
+ * in the specified context, and whose rows are 'width' pixels wide. Returns
+ * false if the error rows could not be allocated.
+ */
+bool epd_dither_begin(epd_dither_t* dither,
+                      const epd_ctx_t* ctx,
+                      enum EEpdDitherMethods method,
+                      uint16_t x,
+                      uint16_t y,
+                      uint16_t width);
+
+/*
+ * Dither the next row of the image, containing 'width' grayscale pixels (0 is
+ * black, 255 is white), and pack it into the framebuffer. Pixels outside of
+ * the clip rectangle of the context are processed, but not written.
+ */
+void epd_dither_row(epd_dither_t* dither, const uint8_t* gray);
+
+/*
+ * Finish a dithering operation, freeing its error rows.
+ */
+void epd_dither_end(epd_dither_t* dither);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_DITHER_H_ */
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_image.h"
+
+#include <string.h>
+
+#include "epaper_display_utils.h"
+
+/*
+ * State of a PackBits decoder. Runs can span several rows, so the state is kept
+ * between rows.
+ */
+typedef struct {
+    const uint8_t* cur;
+    const uint8_t* end;
+
+    /* Remaining bytes of the current run, and whether it's a repeated byte */
+    uint16_t remaining;
+    bool repeat;
+} packbits_t;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Decode the next 'size' bytes of a PackBits stream into 'dst'. Returns false
+ * if the stream ends too early.
+ */
+static bool packbits_read(packbits_t* packbits, uint8_t* dst, size_t size) {
+    while (size > 0) {
+        if (packbits->remaining == 0) {
+            if (packbits->cur >= packbits->end)
+                return false;
+
+            /* A header of -128 is a no-op */
+            const int8_t header = (int8_t)*packbits->cur++;
+            if (header == -128)
+                continue;
+
+            packbits->repeat    = header < 0;
+            packbits->remaining = packbits->repeat ? 1 - header : header + 1;
+        }
+
+        size_t count = packbits->remaining;
+        if (count > size)
+            count = size;
+
+        const size_t needed = packbits->repeat ? 1 : count;
+        if ((size_t)(packbits->end - packbits->cur) < needed)
+            return false;
+
+        if (packbits->repeat) {
+            memset(dst, *packbits->cur, count);
+        } else {
+            memcpy(dst, packbits->cur, count);
+            packbits->cur += count;
+        }
+
+        packbits->remaining -= count;
+        if (packbits->repeat && packbits->remaining == 0)
+            packbits->cur++;
+
+        dst += count;
+        size -= count;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool epd_draw_image(const epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    const epd_image_t* image) {
+    const size_t stride = (image->width + 7) / 8;
+
+    switch (image->compression) {
+        case EPD_IMAGE_RAW:
+            if (image->size < stride * image->height) {
+                EPD_LOG("Image data is too short (%zu bytes).", image->size);
+                return false;
+            }
+
+            epd_copy_bitmap(ctx,
+                            x,
+                            y,
+                            image->width,
+                            image->height,
+                            image->data,
+                            stride);
+            return true;
+
+        case EPD_IMAGE_PACKBITS:
+            break;
+
+        default:
+            EPD_LOG("Invalid image compression (%d).", image->compression);
+            return false;
+    }
+
+    if (image->width > EPD_IMAGE_MAX_WIDTH) {
+        EPD_LOG("Compressed image is too wide (%d pixels).", image->width);
+        return false;
+    }
+
+    packbits_t packbits = {
+        .cur       = image->data,
+        .end       = image->data + image->size,
+        .remaining = 0,
+        .repeat    = false,
+    };
+
+    uint8_t row[EPD_IMAGE_MAX_WIDTH / 8];
+    for (uint16_t i = 0; i < image->height; i++) {
+        if (!packbits_read(&packbits, row, stride)) {
+            EPD_LOG("Compressed image data ends at row %d.", i);
+            return false;
+        }
+
+        epd_copy_bitmap(ctx, x, y + i, image->width, 1, row, stride);
+    }
+
+    return true;
+}
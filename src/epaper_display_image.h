@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_IMAGE_H_
+#define EPAPER_DISPLAY_IMAGE_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maximum width of a compressed image, in pixels. Compressed images are
+ * decoded one row at a time into a buffer of this size. If it's changed, it
+ * must also be changed in 'tools/epd_asset.py', which stores wider images
+ * uncompressed.
+ */
+#define EPD_IMAGE_MAX_WIDTH 512
+
+/*
+ * Compression methods of the image data.
+ */
+enum EEpdImageCompression {
+    EPD_IMAGE_RAW,      /* Packed rows, without compression */
+    EPD_IMAGE_PACKBITS, /* Packed rows, compressed with PackBits as a whole */
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_image epd_image_t;
+
+/*
+ * Structure containing a 1bpp image, usually generated by 'tools/epd_asset.py'.
+ * Each row starts in a new byte, the leftmost pixel of a row is stored in the
+ * most significant bit, and set bits are white, just like in the framebuffer.
+ */
+struct epd_image {
+    uint16_t width, height;
+    enum EEpdImageCompression compression;
+
+    /* Image data, and its size in bytes */
+    const uint8_t* data;
+    size_t size;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Draw an image with its top-left corner at (x, y), replacing the framebuffer
+ * content. Returns false if the image data is invalid.
+ */
+bool epd_draw_image(const epd_ctx_t* ctx,
+                    uint16_t x,
+                    uint16_t y,
+                    const epd_image_t* image);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_IMAGE_H_ */
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_layers.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epaper_display_utils.h"
+
+/*
+ * Extend the dirty rows of the layer stack with the range [y0, y1).
+ */
+static void layers_mark_dirty(epd_layers_t* layers, uint16_t y0, uint16_t y1) {
+    if (y0 >= y1)
+        return;
+
+    if (layers->dirty_y0 >= layers->dirty_y1) {
+        layers->dirty_y0 = y0;
+        layers->dirty_y1 = y1;
+        return;
+    }
+
+    if (y0 < layers->dirty_y0)
+        layers->dirty_y0 = y0;
+    if (y1 > layers->dirty_y1)
+        layers->dirty_y1 = y1;
+}
+
+static inline uint32_t load_word(const uint8_t* ptr) {
+    uint32_t word;
+    memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+static inline void store_word(uint8_t* ptr, uint32_t word) {
+    memcpy(ptr, &word, sizeof(word));
+}
+
+/*
+ * Number of times that a layer was cleared. The clear function only receives
+ * the context, so it can't mark the rows of its layer stack; instead, each
+ * stack marks all of its rows if this changed while it was drawing to a layer.
+ */
+static volatile uint32_t layers_clears = 0;
+
+/*
+ * Clear function of the context while drawing to a layer. Layers don't have a
+ * red plane, so only the first one is filled.
+ */
+static void layers_clear(const epd_ctx_t* ctx, uint8_t color) {
+    switch (color) {
+        case EPD_COLOR_BLACK:
+        case EPD_COLOR_WHITE:
+            memset(ctx->framebuffer,
+                   (color == EPD_COLOR_WHITE) ? 0xFF : 0x00,
+                   ctx->framebuffer_size);
+            break;
+
+        case EPD_COLOR_INVERT:
+            for (size_t i = 0; i < ctx->framebuffer_size; i++)
+                ctx->framebuffer[i] = ~ctx->framebuffer[i];
+            break;
+
+        default:
+            EPD_LOG("Layers can only be cleared in black, white or invert.");
+            return;
+    }
+
+    layers_clears++;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_layers_init(epd_layers_t* layers, epd_ctx_t* ctx) {
+    memset(layers, 0, sizeof(epd_layers_t));
+    layers->ctx = ctx;
+}
+
+void epd_layers_free(epd_layers_t* layers) {
+    if (layers->active != NULL)
+        epd_layer_end(layers);
+
+    for (size_t i = 0; i < layers->count; i++) {
+        free(layers->layers[i].image);
+        free(layers->layers[i].mask);
+    }
+    layers->count = 0;
+}
+
+bool epd_layers_add(epd_layers_t* layers, bool masked) {
+    const epd_ctx_t* ctx = layers->ctx;
+
+    if (layers->count >= EPD_MAX_LAYERS) {
+        EPD_LOG("Layer stack is full (%d layers).", EPD_MAX_LAYERS);
+        return false;
+    }
+
+    epd_layer_t* layer = &layers->layers[layers->count];
+    layer->image       = malloc(ctx->framebuffer_size);
+    layer->mask        = masked ? malloc(ctx->framebuffer_size) : NULL;
+    layer->visible     = true;
+    if (layer->image == NULL || (masked && layer->mask == NULL)) {
+        free(layer->image);
+        free(layer->mask);
+        return false;
+    }
+
+    memset(layer->image, 0xFF, ctx->framebuffer_size);
+    if (masked)
+        memset(layer->mask, 0x00, ctx->framebuffer_size);
+
+    layers->count++;
+    layers_mark_dirty(layers, 0, ctx->height);
+    return true;
+}
+
+void epd_layer_set_visible(epd_layers_t* layers, size_t index, bool visible) {
+    if (index >= layers->count) {
+        EPD_LOG("Invalid layer index (%zu).", index);
+        return;
+    }
+
+    epd_layer_t* layer = &layers->layers[index];
+    if (layer->visible == visible)
+        return;
+
+    layer->visible = visible;
+    layers_mark_dirty(layers, 0, layers->ctx->height);
+}
+
+bool epd_layer_begin(epd_layers_t* layers,
+                     size_t index,
+                     enum EEpdLayerPlanes plane) {
+    epd_ctx_t* ctx = layers->ctx;
+
+    if (index >= layers->count) {
+        EPD_LOG("Invalid layer index (%zu).", index);
+        return false;
+    }
+    if (layers->active != NULL) {
+        EPD_LOG("Already drawing to a layer.");
+        return false;
+    }
+
+    epd_layer_t* layer = &layers->layers[index];
+    uint8_t* target    = (plane == EPD_LAYER_MASK) ? layer->mask : layer->image;
+    if (target == NULL) {
+        EPD_LOG("Layer %zu doesn't have a mask.", index);
+        return false;
+    }
+
+    /* Nothing can be drawn outside of the clip rectangle */
+    layers_mark_dirty(layers, ctx->viewport.clip_y0, ctx->viewport.clip_y1);
+
+    layers->framebuffer     = ctx->framebuffer;
+    layers->framebuffer_red = ctx->framebuffer_red;
+    layers->active          = target;
+    ctx->framebuffer        = target;
+    ctx->framebuffer_red    = NULL;
+
+    /* Track what can be drawn outside of the current clip rectangle */
+    layers->clear            = ctx->display_funcs.clear;
+    layers->clears           = layers_clears;
+    layers->depth            = ctx->viewport_depth;
+    ctx->viewport_low_depth  = ctx->viewport_depth;
+    ctx->display_funcs.clear = layers_clear;
+    return true;
+}
+
+void epd_layer_end(epd_layers_t* layers) {
+    epd_ctx_t* ctx = layers->ctx;
+
+    if (layers->active == NULL) {
+        EPD_LOG("Not drawing to a layer.");
+        return;
+    }
+
+    /*
+     * The rows of the clip rectangle when the layer was bound are already
+     * dirty. Pushing only shrinks it, but popping below that depth can widen
+     * it, and clearing ignores it.
+     */
+    if (layers_clears != layers->clears) {
+        layers_mark_dirty(layers, 0, ctx->height);
+    } else if (ctx->viewport_low_depth < layers->depth) {
+        const epd_viewport_t* widest =
+          (ctx->viewport_low_depth == ctx->viewport_depth)
+            ? &ctx->viewport
+            : &ctx->viewport_stack[ctx->viewport_low_depth];
+        layers_mark_dirty(layers, widest->clip_y0, widest->clip_y1);
+    }
+
+    ctx->framebuffer         = layers->framebuffer;
+    ctx->framebuffer_red     = layers->framebuffer_red;
+    ctx->display_funcs.clear = layers->clear;
+    layers->active           = NULL;
+    layers->framebuffer      = NULL;
+    layers->framebuffer_red  = NULL;
+}
+
+void epd_layers_compose(epd_layers_t* layers) {
+    const epd_ctx_t* ctx = layers->ctx;
+
+    if (layers->active != NULL) {
+        EPD_LOG("Can't composite while drawing to a layer.");
+        return;
+    }
+    if (layers->dirty_y0 >= layers->dirty_y1)
+        return;
+
+    /*
+     * The layers below the topmost visible opaque layer are fully covered, so
+     * they are skipped.
+     */
+    size_t first = 0;
+    for (size_t i = 0; i < layers->count; i++)
+        if (layers->layers[i].visible && layers->layers[i].mask == NULL)
+            first = i;
+
+    /*
+     * The dirty rows are contiguous in memory, so they are processed as a
+     * single range. Each output word is computed from all the layers at once.
+     */
+    const size_t row_size = ctx->width / 8;
+    const size_t start    = layers->dirty_y0 * row_size;
+    const size_t end      = layers->dirty_y1 * row_size;
+
+    size_t i = start;
+    for (; i + 4 <= end; i += 4) {
+        uint32_t out = 0xFFFFFFFF;
+        for (size_t j = first; j < layers->count; j++) {
+            const epd_layer_t* layer = &layers->layers[j];
+            if (!layer->visible)
+                continue;
+
+            const uint32_t image = load_word(&layer->image[i]);
+            if (layer->mask == NULL) {
+                out = image;
+            } else {
+                const uint32_t mask = load_word(&layer->mask[i]);
+                out                 = (out & ~mask) | (image & mask);
+            }
+        }
+        store_word(&ctx->framebuffer[i], out);
+    }
+
+    for (; i < end; i++) {
+        uint8_t out = 0xFF;
+        for (size_t j = first; j < layers->count; j++) {
+            const epd_layer_t* layer = &layers->layers[j];
+            if (!layer->visible)
+                continue;
+
+            if (layer->mask == NULL)
+                out = layer->image[i];
+            else
+                out = (out & ~layer->mask[i]) |
+                      (layer->image[i] & layer->mask[i]);
+        }
+        ctx->framebuffer[i] = out;
+    }
+
+    layers->dirty_y0 = 0;
+    layers->dirty_y1 = 0;
+}
+
+bool epd_layers_flush(epd_layers_t* layers) {
+    epd_layers_compose(layers);
+    return epd_flush(layers->ctx);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_LAYERS_H_
+#define EPAPER_DISPLAY_LAYERS_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maximum number of layers in a layer stack.
+ */
+#define EPD_MAX_LAYERS 4
+
+/*
+ * Planes of a layer that can be drawn to.
+ */
+enum EEpdLayerPlanes {
+    /* Pixels of the layer */
+    EPD_LAYER_IMAGE,
+
+    /*
+     * Visibility of each pixel of the layer. White pixels show the layer, and
+     * black pixels show the layers below it.
+     */
+    EPD_LAYER_MASK,
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_layer epd_layer_t;
+typedef struct epd_layers epd_layers_t;
+
+/*
+ * Single layer, with the same size and layout as the framebuffer.
+ */
+struct epd_layer {
+    uint8_t* image;
+
+    /* Mask of the layer, or NULL if the layer is opaque */
+    uint8_t* mask;
+
+    /* Hidden layers are ignored when compositing */
+    bool visible;
+};
+
+/*
+ * Stack of layers that are composited into the framebuffer of a context. The
+ * first layer is the one at the bottom. If it has a mask, the pixels that are
+ * not covered by any layer are white.
+ *
+ * Layers only contain black and white pixels. In three-color models, the red
+ * plane of the context is drawn directly, and can't be drawn to while drawing
+ * to a layer.
+ */
+struct epd_layers {
+    epd_ctx_t* ctx;
+
+    epd_layer_t layers[EPD_MAX_LAYERS];
+    size_t count;
+
+    /*
+     * Range of rows [dirty_y0, dirty_y1) that changed in any layer since the
+     * last composition, in display coordinates.
+     */
+    uint16_t dirty_y0, dirty_y1;
+
+    /*
+     * Layer plane being drawn to, and the framebuffer planes of the context,
+     * which are replaced by that plane (and no red plane) until 'epd_layer_end'
+     * is called.
+     */
+    uint8_t* active;
+    uint8_t* framebuffer;
+    uint8_t* framebuffer_red;
+
+    /*
+     * Clear function of the context, which is replaced while drawing to a
+     * layer, the number of layer clears when 'epd_layer_begin' was called, and
+     * the depth of the viewport stack at that time.
+     */
+    void (*clear)(const epd_ctx_t* ctx, uint8_t color);
+    uint32_t clears;
+    size_t depth;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Initialize an empty layer stack for the specified context.
+ */
+void epd_layers_init(epd_layers_t* layers, epd_ctx_t* ctx);
+
+/*
+ * Free all the layers of a layer stack.
+ */
+void epd_layers_free(epd_layers_t* layers);
+
+/*
+ * Add a layer on top of the stack, with a white image. If 'masked' is true,
+ * the layer has a mask, which is initially black (transparent). The index of
+ * the new layer is the number of layers that were added before it. Returns
+ * false if the stack is full or the layer couldn't be allocated.
+ */
+bool epd_layers_add(epd_layers_t* layers, bool masked);
+
+/*
+ * Show or hide the specified layer.
+ */
+void epd_layer_set_visible(epd_layers_t* layers, size_t index, bool visible);
+
+/*
+ * Redirect the drawing functions of the context to a plane of the specified
+ * layer, until 'epd_layer_end' is called. Only the rows inside of the current
+ * clip rectangle are marked as dirty, so pushing a clip rectangle around the
+ * modified area before this call reduces the composition work.
+ *
+ * If the clip rectangle is widened by popping it before 'epd_layer_end', the
+ * rows of the widest one are marked, and 'epd_clear' marks the whole layer.
+ * Code that writes the framebuffer directly, like the 'clear' function of the
+ * C++ canvas, must push a clip rectangle around what it writes.
+ */
+bool epd_layer_begin(epd_layers_t* layers,
+                     size_t index,
+                     enum EEpdLayerPlanes plane);
+
+/*
+ * Stop drawing to a layer, restoring the framebuffer of the context.
+ */
+void epd_layer_end(epd_layers_t* layers);
+
+/*
+ * Composite the dirty rows of all visible layers into the framebuffer of the
+ * context.
+ */
+void epd_layers_compose(epd_layers_t* layers);
+
+/*
+ * Composite the layers, and flush the context. See 'epd_flush'.
+ */
+bool epd_layers_flush(epd_layers_t* layers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_LAYERS_H_ */
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_persist.h"
+
+#include <string.h>
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#include "epaper_display_utils.h"
+
+/*
+ * Value of the 'magic' member of a valid header ("EPDF").
+ */
+#define PERSIST_MAGIC 0x46445045
+
+/*
+ * Header stored in the first flash page of the saved frame. The framebuffer
+ * planes are stored starting at the next page.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t model;
+    uint32_t size;
+    uint32_t crc;
+} persist_header_t;
+
+/*
+ * Maximum time to wait for the other core to stop executing from flash, in
+ * milliseconds.
+ */
+#define PERSIST_SAFE_TIMEOUT_MS 100
+
+/*
+ * Flash writes of a frame, prepared before the flash is made unavailable.
+ * Full pages of the framebuffer are programmed from it directly; its last
+ * partial page and the header are padded in page buffers.
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t whole_size;
+    const uint8_t* tail;
+    const uint8_t* header;
+} persist_write_t;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Address of the saved frame in the memory-mapped flash.
+ */
+static inline const uint8_t* persist_flash_data(void) {
+    return (const uint8_t*)(XIP_BASE + EPD_PERSIST_FLASH_OFFSET);
+}
+
+static inline const persist_header_t* persist_flash_header(void) {
+    return (const persist_header_t*)persist_flash_data();
+}
+
+/*
+ * Size of the saved frame. The red plane of three-color models is allocated
+ * right after the first plane, so both are saved as a single block.
+ */
+static inline size_t persist_frame_size(const epd_ctx_t* ctx) {
+    return ctx->framebuffer_size * ((ctx->framebuffer_red != NULL) ? 2 : 1);
+}
+
+/*
+ * Bitwise CRC-32 (reflected, polynomial 0xEDB88320). Only used when saving and
+ * restoring, so a lookup table is not worth its size.
+ */
+static uint32_t persist_crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+/*
+ * Check if the flash contains a valid saved frame for the specified context.
+ */
+static bool persist_is_valid(const epd_ctx_t* ctx,
+                             const persist_header_t* header) {
+    const uint8_t* data = persist_flash_data() + FLASH_PAGE_SIZE;
+    return header->magic == PERSIST_MAGIC && header->model == ctx->model &&
+           header->size == persist_frame_size(ctx) &&
+           header->crc == persist_crc32(data, header->size);
+}
+
+/*
+ * Erase the flash sectors of the saved frame, and program a prepared frame.
+ * Called through 'flash_safe_execute', with interrupts disabled and the other
+ * core locked out.
+ */
+static void persist_write(void* param) {
+    const persist_write_t* write = param;
+
+    flash_range_erase(EPD_PERSIST_FLASH_OFFSET,
+                      EPD_PERSIST_FLASH_SECTORS * FLASH_SECTOR_SIZE);
+
+    if (write->whole_size > 0)
+        flash_range_program(EPD_PERSIST_FLASH_OFFSET + FLASH_PAGE_SIZE,
+                            write->data,
+                            write->whole_size);
+    if (write->tail != NULL)
+        flash_range_program(EPD_PERSIST_FLASH_OFFSET + FLASH_PAGE_SIZE +
+                              write->whole_size,
+                            write->tail,
+                            FLASH_PAGE_SIZE);
+
+    /*
+     * The header is written last, so a frame that was interrupted while being
+     * saved is never considered valid.
+     */
+    flash_range_program(EPD_PERSIST_FLASH_OFFSET,
+                        write->header,
+                        FLASH_PAGE_SIZE);
+}
+
+/*
+ * Clear the header of the saved frame. Called through 'flash_safe_execute'.
+ */
+static void persist_clear(void* param) {
+    flash_range_program(EPD_PERSIST_FLASH_OFFSET, param, FLASH_PAGE_SIZE);
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool epd_persist_save(const epd_ctx_t* ctx) {
+    const size_t size       = persist_frame_size(ctx);
+    const size_t whole_size = size - size % FLASH_PAGE_SIZE;
+
+    if (FLASH_PAGE_SIZE + size >
+        EPD_PERSIST_FLASH_SECTORS * FLASH_SECTOR_SIZE) {
+        EPD_LOG("Framebuffer doesn't fit in the persistent flash sectors.");
+        return false;
+    }
+
+    /* Avoid wearing the flash if the same frame is already saved */
+    const uint8_t* saved_data = persist_flash_data() + FLASH_PAGE_SIZE;
+    if (persist_is_valid(ctx, persist_flash_header()) &&
+        memcmp(saved_data, ctx->framebuffer, size) == 0)
+        return true;
+
+    /*
+     * The flash is programmed one page at a time, so the header and the last
+     * partial page of the framebuffer are padded in page buffers. They are
+     * prepared here, since the flash can't be read while it's written.
+     */
+    static uint8_t tail[FLASH_PAGE_SIZE];
+    static uint8_t header_page[FLASH_PAGE_SIZE];
+
+    memset(tail, 0xFF, sizeof(tail));
+    memcpy(tail, &ctx->framebuffer[whole_size], size - whole_size);
+
+    const persist_header_t header = {
+        .magic = PERSIST_MAGIC,
+        .model = ctx->model,
+        .size  = size,
+        .crc   = persist_crc32(ctx->framebuffer, size),
+    };
+    memset(header_page, 0xFF, sizeof(header_page));
+    memcpy(header_page, &header, sizeof(header));
+
+    persist_write_t write = {
+        .data       = ctx->framebuffer,
+        .whole_size = whole_size,
+        .tail       = (whole_size < size) ? tail : NULL,
+        .header     = header_page,
+    };
+    const int result =
+      flash_safe_execute(persist_write, &write, PERSIST_SAFE_TIMEOUT_MS);
+    if (result != PICO_OK) {
+        EPD_LOG("Can't write the flash safely (error %d).", result);
+        return false;
+    }
+
+    return true;
+}
+
+bool epd_persist_restore(epd_ctx_t* ctx) {
+    if (ctx->init_wait != EPD_INIT_DONE) {
+        EPD_LOG("Can't restore a frame before the display is initialized.");
+        return false;
+    }
+
+    if (!persist_is_valid(ctx, persist_flash_header()))
+        return false;
+
+    memcpy(ctx->framebuffer,
+           persist_flash_data() + FLASH_PAGE_SIZE,
+           persist_frame_size(ctx));
+
+    /*
+     * The display is still showing this frame, but its memory was lost when it
+     * was powered off.
+     */
+    ctx->display_funcs.load_frame(ctx);
+    epd_assume_displayed(ctx);
+    return true;
+}
+
+void epd_persist_erase(void) {
+    /* Clearing the magic number is enough, and doesn't need an erase */
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0x00, sizeof(page));
+
+    const int result =
+      flash_safe_execute(persist_clear, page, PERSIST_SAFE_TIMEOUT_MS);
+    if (result != PICO_OK)
+        EPD_LOG("Can't write the flash safely (error %d).", result);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_PERSIST_H_
+#define EPAPER_DISPLAY_PERSIST_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hardware/flash.h"
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Number of flash sectors reserved for the saved frame. They must fit a page
+ * with the header, followed by the framebuffer (both planes, in three-color
+ * models).
+ */
+#ifndef EPD_PERSIST_FLASH_SECTORS
+#define EPD_PERSIST_FLASH_SECTORS 3
+#endif
+
+/*
+ * Offset of the saved frame from the start of the flash. By default, the last
+ * sectors of the flash are used, so the program must not use them.
+ */
+#ifndef EPD_PERSIST_FLASH_OFFSET
+#define EPD_PERSIST_FLASH_OFFSET                                               \
+    (PICO_FLASH_SIZE_BYTES - EPD_PERSIST_FLASH_SECTORS * FLASH_SECTOR_SIZE)
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Save the framebuffer of the context in flash, so it can be restored with
+ * 'epd_persist_restore' after a reboot. It should be called after the last
+ * 'epd_flush' call before the device powers off, so the saved frame is the one
+ * shown by the display. If the saved frame is already identical, the flash is
+ * not written.
+ *
+ * The flash is written with 'flash_safe_execute', which disables interrupts
+ * and locks out the other core. If the other core is running, it must have
+ * called 'flash_safe_execute_core_init' (or run FreeRTOS); otherwise, the
+ * frame is not saved. Returns false if it couldn't be saved.
+ */
+bool epd_persist_save(const epd_ctx_t* ctx);
+
+/*
+ * Restore the frame saved by 'epd_persist_save' into the framebuffer and into
+ * the memory of the display, without refreshing it. The next 'epd_flush' call
+ * only sends the rows that changed after the restore. The display must be
+ * initialized.
+ *
+ * Returns false if there is no valid saved frame for this display model. In
+ * that case, the framebuffer is not modified.
+ */
+bool epd_persist_restore(epd_ctx_t* ctx);
+
+/*
+ * Invalidate the saved frame, so the next 'epd_persist_restore' call fails.
+ * Like 'epd_persist_save', the other core must allow flash writes.
+ */
+void epd_persist_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_PERSIST_H_ */
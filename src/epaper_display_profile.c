@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_profile.h"
+
+#ifdef EPD_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Statistics of a single primitive.
+ */
+typedef struct {
+    uint32_t count;
+    uint64_t total;
+    uint32_t min, max;
+    uint32_t buckets[EPD_PROFILE_BUCKETS];
+} profile_entry_t;
+
+static profile_entry_t profile_entries[EPD_PROF_COUNT];
+
+/* Names of the primitives in the output of 'epd_profile_dump' */
+static const char* const profile_names[EPD_PROF_COUNT] = {
+    [EPD_PROF_FLUSH]                  = "flush",
+    [EPD_PROF_RESET]                  = "reset",
+    [EPD_PROF_LOAD_FRAME]             = "load_frame",
+    [EPD_PROF_SLEEP]                  = "sleep",
+    [EPD_PROF_CLEAR]                  = "clear",
+    [EPD_PROF_SCROLL]                 = "scroll",
+    [EPD_PROF_DRAW_PIXEL]             = "draw_pixel",
+    [EPD_PROF_DRAW_LINE]              = "draw_line",
+    [EPD_PROF_DRAW_RECT]              = "draw_rect",
+    [EPD_PROF_DRAW_FILLED_RECT]       = "draw_filled_rect",
+    [EPD_PROF_DRAW_CIRCLE]            = "draw_circle",
+    [EPD_PROF_DRAW_FILLED_CIRCLE]     = "draw_filled_circle",
+    [EPD_PROF_DRAW_ARC]               = "draw_arc",
+    [EPD_PROF_DRAW_ROUND_RECT]        = "draw_round_rect",
+    [EPD_PROF_DRAW_FILLED_ROUND_RECT] = "draw_filled_round_rect",
+    [EPD_PROF_DRAW_POLYGON]           = "draw_polygon",
+    [EPD_PROF_DRAW_FILLED_POLYGON]    = "draw_filled_polygon",
+    [EPD_PROF_DRAW_BITMAP]            = "draw_bitmap",
+    [EPD_PROF_DRAW_BITMAP_SCALED]     = "draw_bitmap_scaled",
+    [EPD_PROF_COPY_BITMAP]            = "copy_bitmap",
+    [EPD_PROF_DRAW_CHAR]              = "draw_char",
+    [EPD_PROF_DRAW_STR]               = "draw_str",
+};
+
+/*
+ * Histogram bucket of a latency: the number of significant bits of the value.
+ */
+static inline uint32_t profile_bucket(uint32_t elapsed) {
+    const uint32_t bits = (elapsed == 0) ? 0 : 32 - __builtin_clz(elapsed);
+    return (bits < EPD_PROFILE_BUCKETS) ? bits : EPD_PROFILE_BUCKETS - 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_profile_record(enum EEpdProfilePrimitives primitive,
+                        uint32_t elapsed) {
+    profile_entry_t* entry = &profile_entries[primitive];
+
+    if (entry->count == 0 || elapsed < entry->min)
+        entry->min = elapsed;
+    if (elapsed > entry->max)
+        entry->max = elapsed;
+
+    entry->count++;
+    entry->total += elapsed;
+    entry->buckets[profile_bucket(elapsed)]++;
+}
+
+void epd_profile_reset(void) {
+    memset(profile_entries, 0, sizeof(profile_entries));
+
+#ifdef EPD_PROFILE_CYCLES
+    /* Enable the trace unit, which contains the cycle counter */
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#endif
+}
+
+void epd_profile_dump(void) {
+#ifdef EPD_PROFILE_CYCLES
+    const char* unit = "cycles";
+#else
+    const char* unit = "us";
+#endif
+    printf("epd_profile unit=%s buckets=%d\n", unit, EPD_PROFILE_BUCKETS);
+
+    for (int i = 0; i < EPD_PROF_COUNT; i++) {
+        const profile_entry_t* entry = &profile_entries[i];
+        if (entry->count == 0)
+            continue;
+
+        printf("epd_profile name=%s count=%lu total=%llu min=%lu max=%lu hist=",
+               profile_names[i],
+               (unsigned long)entry->count,
+               (unsigned long long)entry->total,
+               (unsigned long)entry->min,
+               (unsigned long)entry->max);
+
+        /* Trailing empty buckets are omitted */
+        int last = EPD_PROFILE_BUCKETS - 1;
+        while (last > 0 && entry->buckets[last] == 0)
+            last--;
+        for (int j = 0; j <= last; j++)
+            printf((j == 0) ? "%lu" : ",%lu", (unsigned long)entry->buckets[j]);
+        putchar('\n');
+    }
+
+    printf("epd_profile end\n");
+}
+
+#endif /* EPD_PROFILE */
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_PROFILE_H_
+#define EPAPER_DISPLAY_PROFILE_H_ 1
+
+#include <stdint.h>
+
+#ifdef EPD_PROFILE
+#include "pico/time.h"
+#if defined(__ARM_ARCH_8M_MAIN__) && !defined(EPD_PROFILE_US)
+#include "hardware/structs/m33.h"
+#define EPD_PROFILE_CYCLES 1
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Profiler for the drawing and control functions of 'epaper_display.h'. It's
+ * only compiled if EPD_PROFILE is defined (with the EPD_PROFILE option of
+ * CMake); otherwise, the instrumentation of those functions expands to nothing,
+ * and the functions below do nothing.
+ *
+ * The latency of each call is measured with the cycle counter of the Cortex-M33
+ * cores, or in microseconds with the system timer if EPD_PROFILE_US is defined
+ * (or when running on the RISC-V cores). Each primitive keeps its call count,
+ * total, minimum and maximum latency, and a histogram where bucket N counts the
+ * calls that took less than 2^N units (and at least 2^(N-1), for N > 0). The
+ * last bucket also counts all the longer calls.
+ */
+#ifndef EPD_PROFILE_BUCKETS
+#define EPD_PROFILE_BUCKETS 32
+#endif
+
+/*
+ * Primitives measured by the profiler.
+ */
+enum EEpdProfilePrimitives {
+    EPD_PROF_FLUSH,
+    EPD_PROF_RESET,
+    EPD_PROF_LOAD_FRAME,
+    EPD_PROF_SLEEP,
+    EPD_PROF_CLEAR,
+    EPD_PROF_SCROLL,
+    EPD_PROF_DRAW_PIXEL,
+    EPD_PROF_DRAW_LINE,
+    EPD_PROF_DRAW_RECT,
+    EPD_PROF_DRAW_FILLED_RECT,
+    EPD_PROF_DRAW_CIRCLE,
+    EPD_PROF_DRAW_FILLED_CIRCLE,
+    EPD_PROF_DRAW_ARC,
+    EPD_PROF_DRAW_ROUND_RECT,
+    EPD_PROF_DRAW_FILLED_ROUND_RECT,
+    EPD_PROF_DRAW_POLYGON,
+    EPD_PROF_DRAW_FILLED_POLYGON,
+    EPD_PROF_DRAW_BITMAP,
+    EPD_PROF_DRAW_BITMAP_SCALED,
+    EPD_PROF_COPY_BITMAP,
+    EPD_PROF_DRAW_CHAR,
+    EPD_PROF_DRAW_STR,
+
+    EPD_PROF_COUNT,
+};
+
+#ifdef EPD_PROFILE
+
+/*
+ * Current value of the profiler clock, in its units.
+ */
+static inline uint32_t epd_profile_now(void) {
+#ifdef EPD_PROFILE_CYCLES
+    return m33_hw->dwt_cyccnt;
+#else
+    return time_us_32();
+#endif
+}
+
+/*
+ * Add a call with the specified latency to the statistics of a primitive.
+ */
+void epd_profile_record(enum EEpdProfilePrimitives primitive, uint32_t elapsed);
+
+/*
+ * Clear all statistics, and start the cycle counter if it's used. Called by
+ * 'epd_init_begin'.
+ */
+void epd_profile_reset(void);
+
+/*
+ * Print the statistics of each primitive that was called, through stdio. The
+ * output starts with a header line, which includes the unit of the latencies:
+ *
+ *     epd_profile unit=cycles buckets=32
+ *
+ * followed by one line per primitive, and an end line:
+ *
+ *     epd_profile name=draw_str count=12 total=83410 min=6520 max=7410
+ *         hist=0,0,0,0,0,0,0,0,0,0,0,0,0,12
+ *     epd_profile end
+ *
+ * The fields are separated by spaces, and each one is a key and a value. The
+ * histogram has one count per bucket, up to the last non-empty one.
+ */
+void epd_profile_dump(void);
+
+/*
+ * Measure the latency of the code between these two macros, which must be in
+ * the same scope, and record it for the specified primitive.
+ */
+#define EPD_PROFILE_BEGIN() const uint32_t epd_profile_start = epd_profile_now()
+#define EPD_PROFILE_END(PRIMITIVE)                                             \
+    epd_profile_record((PRIMITIVE), epd_profile_now() - epd_profile_start)
+
+#else /* !EPD_PROFILE */
+
+static inline void epd_profile_reset(void) {}
+static inline void epd_profile_dump(void) {}
+
+#define EPD_PROFILE_BEGIN()                                                    \
+    do {                                                                       \
+    } while (0)
+#define EPD_PROFILE_END(PRIMITIVE)                                             \
+    do {                                                                       \
+    } while (0)
+
+#endif /* !EPD_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_PROFILE_H_ */
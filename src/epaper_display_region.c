@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_region.h"
+
+#include <string.h>
+
+#include "epaper_display_utils.h"
+
+/*
+ * Shared pool for regions saved without a buffer, allocated as a stack.
+ */
+static uint8_t region_pool[EPD_REGION_POOL_SIZE];
+static size_t region_pool_used = 0;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Store the part of a rectangle in context coordinates that is inside of the
+ * clip rectangle, in display coordinates. Empty rectangles are stored as
+ * (0, 0, 0, 0).
+ */
+static void region_clip(const epd_ctx_t* ctx,
+                        epd_region_t* region,
+                        int16_t x,
+                        int16_t y,
+                        uint16_t width,
+                        uint16_t height) {
+    const epd_viewport_t* viewport = &ctx->viewport;
+
+    int32_t x0 = x + viewport->origin_x;
+    int32_t y0 = y + viewport->origin_y;
+    int32_t x1 = x0 + width;
+    int32_t y1 = y0 + height;
+    if (x0 < viewport->clip_x0)
+        x0 = viewport->clip_x0;
+    if (y0 < viewport->clip_y0)
+        y0 = viewport->clip_y0;
+    if (x1 > viewport->clip_x1)
+        x1 = viewport->clip_x1;
+    if (y1 > viewport->clip_y1)
+        y1 = viewport->clip_y1;
+
+    if (x0 >= x1 || y0 >= y1)
+        x0 = y0 = x1 = y1 = 0;
+
+    region->x0 = x0;
+    region->y0 = y0;
+    region->x1 = x1;
+    region->y1 = y1;
+}
+
+/*
+ * Number of framebuffer bytes that contain each row of a region.
+ */
+static inline size_t region_row_bytes(const epd_region_t* region) {
+    if (region->x0 >= region->x1)
+        return 0;
+    return (region->x1 - 1) / 8 - region->x0 / 8 + 1;
+}
+
+/*
+ * Number of bytes saved from each framebuffer plane.
+ */
+static inline size_t region_plane_size(const epd_region_t* region) {
+    return region_row_bytes(region) * (region->y1 - region->y0);
+}
+
+static void region_save_plane(const epd_ctx_t* ctx,
+                              const epd_region_t* region,
+                              const uint8_t* plane,
+                              uint8_t* dst) {
+    const size_t row_size  = ctx->width / 8;
+    const size_t row_bytes = region_row_bytes(region);
+
+    const uint8_t* src = &plane[region->y0 * row_size + region->x0 / 8];
+    for (uint16_t y = region->y0; y < region->y1; y++) {
+        memcpy(dst, src, row_bytes);
+        src += row_size;
+        dst += row_bytes;
+    }
+}
+
+/*
+ * Write the saved bytes of a plane back into the framebuffer. The whole bytes
+ * of each row are copied at once, and the partial bytes at each end are masked,
+ * so the pixels next to the region are not modified.
+ */
+static void region_restore_plane(const epd_ctx_t* ctx,
+                                 const epd_region_t* region,
+                                 uint8_t* plane,
+                                 const uint8_t* src) {
+    const size_t row_size    = ctx->width / 8;
+    const size_t row_bytes   = region_row_bytes(region);
+    const uint8_t first_mask = 0xFF >> (region->x0 % 8);
+    const uint8_t last_mask  = 0xFF << (7 - (region->x1 - 1) % 8);
+
+    uint8_t* dst = &plane[region->y0 * row_size + region->x0 / 8];
+    for (uint16_t y = region->y0; y < region->y1; y++) {
+        if (row_bytes == 1) {
+            const uint8_t mask = first_mask & last_mask;
+            dst[0]             = (dst[0] & ~mask) | (src[0] & mask);
+        } else {
+            const size_t last = row_bytes - 1;
+            dst[0] = (dst[0] & ~first_mask) | (src[0] & first_mask);
+            memcpy(&dst[1], &src[1], last - 1);
+            dst[last] = (dst[last] & ~last_mask) | (src[last] & last_mask);
+        }
+
+        src += row_bytes;
+        dst += row_size;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t epd_region_size(const epd_ctx_t* ctx,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height) {
+    epd_region_t region;
+    region_clip(ctx, &region, x, y, width, height);
+
+    const size_t planes = (ctx->framebuffer_red != NULL) ? 2 : 1;
+    return region_plane_size(&region) * planes;
+}
+
+bool epd_save_region(const epd_ctx_t* ctx,
+                     epd_region_t* region,
+                     int16_t x,
+                     int16_t y,
+                     uint16_t width,
+                     uint16_t height,
+                     uint8_t* buffer,
+                     size_t buffer_size) {
+    /* A region that couldn't be saved is empty, so restoring it does nothing */
+    memset(region, 0, sizeof(epd_region_t));
+
+    epd_region_t saved;
+    region_clip(ctx, &saved, x, y, width, height);
+    saved.red    = (ctx->framebuffer_red != NULL);
+    saved.size   = region_plane_size(&saved) * (saved.red ? 2 : 1);
+    saved.pooled = (buffer == NULL);
+
+    if (saved.pooled) {
+        if (saved.size > EPD_REGION_POOL_SIZE - region_pool_used) {
+            EPD_LOG("Region pool is full (%d bytes).", EPD_REGION_POOL_SIZE);
+            return false;
+        }
+        buffer = &region_pool[region_pool_used];
+        region_pool_used += saved.size;
+    } else if (buffer_size < saved.size) {
+        EPD_LOG("Region buffer is too small (%zu bytes, %zu needed).",
+                buffer_size,
+                saved.size);
+        return false;
+    }
+    saved.data = buffer;
+
+    if (saved.size > 0) {
+        region_save_plane(ctx, &saved, ctx->framebuffer, saved.data);
+        if (saved.red)
+            region_save_plane(ctx,
+                              &saved,
+                              ctx->framebuffer_red,
+                              &saved.data[region_plane_size(&saved)]);
+    }
+
+    *region = saved;
+    return true;
+}
+
+void epd_restore_region(const epd_ctx_t* ctx, const epd_region_t* region) {
+    if (region->size == 0)
+        return;
+
+    region_restore_plane(ctx, region, ctx->framebuffer, region->data);
+
+    /* The red plane is only restored if both the region and context have it */
+    if (region->red && ctx->framebuffer_red != NULL)
+        region_restore_plane(ctx,
+                             region,
+                             ctx->framebuffer_red,
+                             &region->data[region_plane_size(region)]);
+}
+
+void epd_release_region(epd_region_t* region) {
+    if (!region->pooled)
+        return;
+
+    if (region->data + region->size != &region_pool[region_pool_used]) {
+        EPD_LOG("Pooled regions must be released in reverse order.");
+        return;
+    }
+
+    region_pool_used -= region->size;
+    memset(region, 0, sizeof(epd_region_t));
+}
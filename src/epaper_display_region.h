@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_REGION_H_
+#define EPAPER_DISPLAY_REGION_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Size of the shared pool used by 'epd_save_region' when no buffer is
+ * specified, in bytes. Can be overridden at compile time.
+ */
+#ifndef EPD_REGION_POOL_SIZE
+#define EPD_REGION_POOL_SIZE 4096
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_region epd_region_t;
+
+/*
+ * Framebuffer content saved by 'epd_save_region', for restoring the area under
+ * popups and menus without drawing it again.
+ */
+struct epd_region {
+    /* Saved rectangle [x0, x1) x [y0, y1), in display coordinates */
+    uint16_t x0, y0, x1, y1;
+
+    /*
+     * Saved framebuffer bytes of each row, followed by the ones of the red
+     * plane if 'red' is true.
+     */
+    uint8_t* data;
+    size_t size;
+    bool red;
+
+    /* The data was allocated from the shared pool */
+    bool pooled;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Get the number of bytes needed for saving the specified rectangle, in
+ * context coordinates. The rectangle is clipped like in 'epd_save_region'.
+ */
+size_t epd_region_size(const epd_ctx_t* ctx,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height);
+
+/*
+ * Save the part of the specified rectangle (in context coordinates) that is
+ * inside of the clip rectangle. The framebuffer bytes that contain each row are
+ * copied into 'buffer', which must have at least the size returned by
+ * 'epd_region_size'.
+ *
+ * If 'buffer' is NULL, the data is allocated from a shared pool instead, and
+ * must be released with 'epd_release_region'. Pooled regions are released in
+ * the opposite order of their allocation, like nested popups are closed.
+ *
+ * Returns false if the buffer or the pool is too small.
+ */
+bool epd_save_region(const epd_ctx_t* ctx,
+                     epd_region_t* region,
+                     int16_t x,
+                     int16_t y,
+                     uint16_t width,
+                     uint16_t height,
+                     uint8_t* buffer,
+                     size_t buffer_size);
+
+/*
+ * Write the saved content back into the framebuffer, independently of the
+ * current viewport. Only the pixels of the saved rectangle are modified. The
+ * region can be restored multiple times.
+ *
+ * Since 'epd_flush' detects the rows that changed, the next flush only sends
+ * the restored rows that differ from the displayed ones, and nothing at all if
+ * the region was not flushed since it was saved.
+ */
+void epd_restore_region(const epd_ctx_t* ctx, const epd_region_t* region);
+
+/*
+ * Release the pool space of a region, which must be the last pooled region
+ * that was saved. Regions with a caller-provided buffer don't need to be
+ * released.
+ */
+void epd_release_region(epd_region_t* region);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_REGION_H_ */
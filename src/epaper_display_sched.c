@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "pico/time.h"
+
+#include "epaper_display_sched.h"
+#include "epaper_display_utils.h"
+
+/*
+ * Add a request for the rows [y0, y1), in display coordinates, to the pending
+ * ones. Its deadline replaces the pending one if it's earlier.
+ */
+static void sched_add(epd_sched_t* sched,
+                      uint16_t y0,
+                      uint16_t y1,
+                      enum EEpdSchedPriorities priority) {
+    if (priority >= EPD_SCHED_PRIORITY_COUNT) {
+        EPD_LOG("Invalid priority: %d", priority);
+        priority = EPD_SCHED_NORMAL;
+    }
+
+    const absolute_time_t deadline =
+      make_timeout_time_us(sched->delay_us[priority]);
+
+    if (!sched->pending) {
+        sched->pending  = true;
+        sched->y0       = y0;
+        sched->y1       = y1;
+        sched->deadline = deadline;
+        return;
+    }
+
+    if (y0 < sched->y0)
+        sched->y0 = y0;
+    if (y1 > sched->y1)
+        sched->y1 = y1;
+    if (absolute_time_diff_us(sched->deadline, deadline) < 0)
+        sched->deadline = deadline;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_sched_init(epd_sched_t* sched,
+                    epd_ctx_t* ctx,
+                    uint32_t min_interval_us) {
+    memset(sched, 0, sizeof(epd_sched_t));
+    sched->ctx             = ctx;
+    sched->min_interval_us = min_interval_us;
+    sched->full_percent    = EPD_SCHED_FULL_PERCENT;
+    sched->last_refresh    = nil_time;
+
+    sched->delay_us[EPD_SCHED_LOW]    = EPD_SCHED_DELAY_LOW_US;
+    sched->delay_us[EPD_SCHED_NORMAL] = EPD_SCHED_DELAY_NORMAL_US;
+    sched->delay_us[EPD_SCHED_URGENT] = EPD_SCHED_DELAY_URGENT_US;
+}
+
+void epd_sched_request(epd_sched_t* sched,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height,
+                       enum EEpdSchedPriorities priority) {
+    const epd_viewport_t* viewport = &sched->ctx->viewport;
+
+    /* Only the rows are kept, but empty rectangles are not requests */
+    const int32_t x0 = x + viewport->origin_x;
+    const int32_t x1 = x0 + width;
+    int32_t y0       = y + viewport->origin_y;
+    int32_t y1       = y0 + height;
+    if (y0 < viewport->clip_y0)
+        y0 = viewport->clip_y0;
+    if (y1 > viewport->clip_y1)
+        y1 = viewport->clip_y1;
+
+    if (y0 >= y1 || x0 >= viewport->clip_x1 || x1 <= viewport->clip_x0)
+        return;
+
+    sched_add(sched, y0, y1, priority);
+}
+
+void epd_sched_request_full(epd_sched_t* sched,
+                            enum EEpdSchedPriorities priority) {
+    sched_add(sched, 0, sched->ctx->height, priority);
+    sched->pending_full = true;
+}
+
+absolute_time_t epd_sched_next_time(const epd_sched_t* sched) {
+    if (!sched->pending)
+        return at_the_end_of_time;
+
+    if (is_nil_time(sched->last_refresh))
+        return sched->deadline;
+
+    /* The deadline can't be earlier than the minimum interval */
+    const absolute_time_t earliest =
+      delayed_by_us(sched->last_refresh, sched->min_interval_us);
+    return (absolute_time_diff_us(sched->deadline, earliest) > 0)
+             ? earliest
+             : sched->deadline;
+}
+
+bool epd_sched_poll(epd_sched_t* sched) {
+    epd_ctx_t* ctx = sched->ctx;
+
+    if (!sched->pending || ctx->init_wait != EPD_INIT_DONE ||
+        !time_reached(epd_sched_next_time(sched)))
+        return false;
+
+    /*
+     * The pending requests are cleared before flushing, so the ones made while
+     * the display refreshes (for example, from the idle hook) are kept for the
+     * next refresh.
+     */
+    const uint16_t y0   = sched->y0;
+    const uint16_t y1   = sched->y1;
+    const bool full     = sched->pending_full;
+    sched->pending      = false;
+    sched->pending_full = false;
+
+    bool refreshed;
+    if (full) {
+        epd_invalidate(ctx);
+        refreshed = epd_flush(ctx);
+    } else if ((uint32_t)(y1 - y0) * 100 >
+               (uint32_t)ctx->height * sched->full_percent) {
+        refreshed = epd_flush(ctx);
+    } else {
+        refreshed = epd_flush_rows(ctx, y0, y1);
+    }
+
+    /* Requests whose rows didn't change don't delay the next refresh */
+    if (refreshed)
+        sched->last_refresh = get_absolute_time();
+
+    return refreshed;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_SCHED_H_
+#define EPAPER_DISPLAY_SCHED_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pico/time.h"
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Default time that a pending update of each priority can wait for others to
+ * be merged with it, in microseconds. See 'epd_sched_set_delay'.
+ */
+#define EPD_SCHED_DELAY_LOW_US    2000000
+#define EPD_SCHED_DELAY_NORMAL_US 100000
+#define EPD_SCHED_DELAY_URGENT_US 0
+
+/*
+ * Default percentage of the display height above which the merged rows are
+ * sent with a full flush. See 'epd_sched_set_full_percent'.
+ */
+#define EPD_SCHED_FULL_PERCENT 75
+
+/*
+ * Priorities of an update request, which set how long it can wait before the
+ * display is refreshed.
+ */
+enum EEpdSchedPriorities {
+    EPD_SCHED_LOW,    /* Can wait for later updates, like a clock */
+    EPD_SCHED_NORMAL, /* Waits briefly, so bursts become one refresh */
+    EPD_SCHED_URGENT, /* Refreshed as soon as the minimum interval allows */
+
+    EPD_SCHED_PRIORITY_COUNT,
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_sched epd_sched_t;
+
+/*
+ * Flush scheduler of a display. Different parts of a program request updates
+ * of the areas they drew, instead of calling 'epd_flush', and the pending
+ * requests are merged into a single flush by 'epd_sched_poll'. All members are
+ * private.
+ */
+struct epd_sched {
+    epd_ctx_t* ctx;
+
+    /*
+     * Minimum time between the end of a refresh and the start of the next
+     * one, maximum delay of each priority, and percentage of the display height
+     * above which the merged rows are sent with a full flush.
+     */
+    uint32_t min_interval_us;
+    uint32_t delay_us[EPD_SCHED_PRIORITY_COUNT];
+    uint8_t full_percent;
+
+    /*
+     * Merged rows of the pending requests [y0, y1), in display coordinates,
+     * whether one of them asked for a full flush, and the time at which the
+     * most urgent one has to be flushed.
+     */
+    bool pending;
+    bool pending_full;
+    uint16_t y0, y1;
+    absolute_time_t deadline;
+
+    /* Time at which the last refresh ended, or nil if there was none */
+    absolute_time_t last_refresh;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Initialize a scheduler for an initialized context, with the specified
+ * minimum time between refreshes, in microseconds, and the default delays.
+ */
+void epd_sched_init(epd_sched_t* sched,
+                    epd_ctx_t* ctx,
+                    uint32_t min_interval_us);
+
+/*
+ * Request an update of the specified rectangle, in context coordinates, after
+ * drawing it. The part outside of the clip rectangle is ignored. Since the
+ * display is written in whole rows, only the rows of the rectangle are kept,
+ * and they are merged with the ones of the pending requests.
+ *
+ * The update is flushed by 'epd_sched_poll' after the delay of its priority,
+ * or earlier if another request is due, but never before the minimum interval
+ * since the last refresh.
+ */
+void epd_sched_request(epd_sched_t* sched,
+                       int16_t x,
+                       int16_t y,
+                       uint16_t width,
+                       uint16_t height,
+                       enum EEpdSchedPriorities priority);
+
+/*
+ * Request an update of the whole framebuffer, which is sent to the display
+ * even if it didn't change, like after 'epd_invalidate'.
+ */
+void epd_sched_request_full(epd_sched_t* sched,
+                            enum EEpdSchedPriorities priority);
+
+/*
+ * Flush the pending requests if they are due, and return true if the display
+ * was refreshed. Should be called periodically; it blocks during the refresh,
+ * like 'epd_flush'.
+ *
+ * If the merged rows cover more than the full percentage of the display, all
+ * the rows that changed are sent, so other changes are not left for a later
+ * refresh. Otherwise, only the merged rows are sent with 'epd_flush_rows'.
+ */
+bool epd_sched_poll(epd_sched_t* sched);
+
+/*
+ * Get the time at which the pending requests will be due, or
+ * 'at_the_end_of_time' if there are none, so the program can sleep until then.
+ */
+absolute_time_t epd_sched_next_time(const epd_sched_t* sched);
+
+/*
+ * Set the maximum time that a pending request of the specified priority can
+ * wait for others, in microseconds.
+ */
+static inline void epd_sched_set_delay(epd_sched_t* sched,
+                                       enum EEpdSchedPriorities priority,
+                                       uint32_t delay_us) {
+    sched->delay_us[priority] = delay_us;
+}
+
+/*
+ * Set the percentage of the display height above which the merged rows are
+ * sent with a full flush.
+ */
+static inline void epd_sched_set_full_percent(epd_sched_t* sched,
+                                              uint8_t percent) {
+    sched->full_percent = percent;
+}
+
+/*
+ * Check if there are requests waiting to be flushed.
+ */
+static inline bool epd_sched_pending(const epd_sched_t* sched) {
+    return sched->pending;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_SCHED_H_ */
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_stream.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "epaper_display_utils.h"
+
+#define SYNC0 0xEB
+#define SYNC1 0x50
+
+/* Size of the position and size at the start of a tile payload */
+#define TILE_HEADER_SIZE 8
+
+/*
+ * States of the packet parser, named after the next expected byte.
+ */
+enum EStreamStates {
+    STATE_SYNC0,
+    STATE_SYNC1,
+    STATE_TYPE,
+    STATE_FLAGS,
+    STATE_SIZE0,
+    STATE_SIZE1,
+    STATE_PAYLOAD,
+    STATE_CRC0,
+    STATE_CRC1,
+};
+
+/*----------------------------------------------------------------------------*/
+
+static uint16_t crc16_update(uint16_t crc, uint8_t byte) {
+    crc ^= (uint16_t)byte << 8;
+    for (int i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+}
+
+static inline uint16_t read_u16(const uint8_t* bytes) {
+    return bytes[0] | (bytes[1] << 8);
+}
+
+/*
+ * Prepare the decoder for receiving the rows of a rectangle.
+ */
+static void stream_start_rows(epd_stream_t* stream,
+                              uint16_t x,
+                              uint16_t y,
+                              uint16_t width,
+                              uint16_t height) {
+    stream->x             = x;
+    stream->y             = y;
+    stream->width         = width;
+    stream->height        = height;
+    stream->row_pos       = 0;
+    stream->row_index     = 0;
+    stream->run_remaining = 0;
+    stream->run_repeat    = false;
+    stream->run_header    = true;
+
+    if (width > EPD_STREAM_MAX_WIDTH) {
+        EPD_LOG("Streamed tile is too wide (%d pixels).", width);
+        stream->error = true;
+    }
+}
+
+/*
+ * Append a decoded byte to the current row, copying the row into the
+ * framebuffer once it's complete.
+ */
+static void stream_put_byte(epd_stream_t* stream, uint8_t byte) {
+    const uint16_t stride = (stream->width + 7) / 8;
+
+    if (stream->row_index >= stream->height) {
+        stream->error = true;
+        return;
+    }
+
+    stream->row[stream->row_pos++] = byte;
+    if (stream->row_pos < stride)
+        return;
+
+    epd_copy_bitmap(stream->ctx,
+                    stream->x,
+                    stream->y + stream->row_index,
+                    stream->width,
+                    1,
+                    stream->row,
+                    stride);
+    stream->row_pos = 0;
+    stream->row_index++;
+}
+
+/*
+ * Process a byte of row data, decompressing it if needed.
+ */
+static void stream_put_data(epd_stream_t* stream, uint8_t byte) {
+    if ((stream->flags & EPD_STREAM_FLAG_PACKBITS) == 0) {
+        stream_put_byte(stream, byte);
+        return;
+    }
+
+    if (stream->run_header) {
+        /* A header of -128 is a no-op */
+        const int8_t header = (int8_t)byte;
+        if (header == -128)
+            return;
+
+        stream->run_repeat    = header < 0;
+        stream->run_remaining = stream->run_repeat ? 1 - header : header + 1;
+        stream->run_header    = false;
+        return;
+    }
+
+    if (stream->run_repeat) {
+        while (stream->run_remaining > 0 && !stream->error) {
+            stream_put_byte(stream, byte);
+            stream->run_remaining--;
+        }
+        stream->run_header = true;
+        return;
+    }
+
+    stream_put_byte(stream, byte);
+    if (--stream->run_remaining == 0)
+        stream->run_header = true;
+}
+
+/*
+ * Start processing a packet once its header is received.
+ */
+static void stream_start_packet(epd_stream_t* stream) {
+    const epd_ctx_t* ctx = stream->ctx;
+
+    stream->error    = false;
+    stream->received = 0;
+
+    switch (stream->type) {
+        case EPD_STREAM_FRAME:
+            stream_start_rows(stream, 0, 0, ctx->width, ctx->height);
+            break;
+
+        case EPD_STREAM_TILE:
+            /* The rows start after the tile header */
+            if (stream->size < TILE_HEADER_SIZE)
+                stream->error = true;
+            break;
+
+        case EPD_STREAM_FLUSH:
+            if (stream->size != 0)
+                stream->error = true;
+            break;
+
+        default:
+            EPD_LOG("Invalid stream packet type (%d).", stream->type);
+            stream->error = true;
+            break;
+    }
+}
+
+/*
+ * Process a byte of the payload of the current packet.
+ */
+static void stream_put_payload(epd_stream_t* stream, uint8_t byte) {
+    const uint16_t pos = stream->received++;
+
+    if (stream->error)
+        return;
+
+    if (stream->type == EPD_STREAM_TILE && pos < TILE_HEADER_SIZE) {
+        stream->tile_header[pos] = byte;
+        if (pos == TILE_HEADER_SIZE - 1)
+            stream_start_rows(stream,
+                              read_u16(&stream->tile_header[0]),
+                              read_u16(&stream->tile_header[2]),
+                              read_u16(&stream->tile_header[4]),
+                              read_u16(&stream->tile_header[6]));
+        return;
+    }
+
+    stream_put_data(stream, byte);
+}
+
+/*
+ * Finish processing a packet once its CRC is received, and reply.
+ */
+static void stream_end_packet(epd_stream_t* stream) {
+    bool ok = !stream->error && stream->crc == stream->expected_crc;
+
+    /* Row packets must contain all of their rows, and nothing else */
+    if (stream->type == EPD_STREAM_FRAME || stream->type == EPD_STREAM_TILE)
+        ok = ok && stream->row_index == stream->height &&
+             stream->row_pos == 0 && stream->run_header;
+
+    if (ok && stream->type == EPD_STREAM_FLUSH)
+        epd_flush(stream->ctx);
+
+    if (stream->reply != NULL)
+        stream->reply(ok ? EPD_STREAM_ACK : EPD_STREAM_NAK);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_stream_init(epd_stream_t* stream,
+                     epd_ctx_t* ctx,
+                     epd_stream_reply_t reply) {
+    memset(stream, 0, sizeof(epd_stream_t));
+    stream->ctx       = ctx;
+    stream->reply     = reply;
+    stream->state     = STATE_SYNC0;
+    stream->last_byte = get_absolute_time();
+}
+
+void epd_stream_feed(epd_stream_t* stream, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        const uint8_t byte = data[i];
+
+        /* The sync bytes and the CRC itself are not part of the CRC */
+        if (stream->state >= STATE_TYPE && stream->state <= STATE_PAYLOAD)
+            stream->crc = crc16_update(stream->crc, byte);
+
+        switch (stream->state) {
+            case STATE_SYNC0:
+                if (byte == SYNC0)
+                    stream->state = STATE_SYNC1;
+                break;
+
+            case STATE_SYNC1:
+                if (byte == SYNC1) {
+                    stream->crc   = 0xFFFF;
+                    stream->state = STATE_TYPE;
+                } else if (byte != SYNC0) {
+                    stream->state = STATE_SYNC0;
+                }
+                break;
+
+            case STATE_TYPE:
+                stream->type  = byte;
+                stream->state = STATE_FLAGS;
+                break;
+
+            case STATE_FLAGS:
+                stream->flags = byte;
+                stream->state = STATE_SIZE0;
+                break;
+
+            case STATE_SIZE0:
+                stream->size  = byte;
+                stream->state = STATE_SIZE1;
+                break;
+
+            case STATE_SIZE1:
+                stream->size |= byte << 8;
+                stream_start_packet(stream);
+                stream->state = (stream->size > 0) ? STATE_PAYLOAD : STATE_CRC0;
+                break;
+
+            case STATE_PAYLOAD:
+                stream_put_payload(stream, byte);
+                if (stream->received == stream->size)
+                    stream->state = STATE_CRC0;
+                break;
+
+            case STATE_CRC0:
+                stream->expected_crc = byte;
+                stream->state        = STATE_CRC1;
+                break;
+
+            case STATE_CRC1:
+                stream->expected_crc |= byte << 8;
+                stream_end_packet(stream);
+                stream->state = STATE_SYNC0;
+                break;
+        }
+    }
+}
+
+void epd_stream_poll_stdio(epd_stream_t* stream) {
+    /* Discard packets that stopped arriving, so the next one can be synced */
+    if (stream->state != STATE_SYNC0 &&
+        absolute_time_diff_us(stream->last_byte, get_absolute_time()) >
+          EPD_STREAM_TIMEOUT_MS * 1000) {
+        if (stream->state > STATE_SYNC1 && stream->reply != NULL)
+            stream->reply(EPD_STREAM_NAK);
+        stream->state = STATE_SYNC0;
+    }
+
+    for (;;) {
+        const int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT)
+            break;
+
+        const uint8_t byte = c;
+        epd_stream_feed(stream, &byte, 1);
+        stream->last_byte = get_absolute_time();
+    }
+}
+
+void epd_stream_reply_stdio(uint8_t reply) {
+    putchar_raw(reply);
+    stdio_flush();
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_STREAM_H_
+#define EPAPER_DISPLAY_STREAM_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decoder for the frame streaming protocol, used for drawing content sent by a
+ * host (see 'tools/epd_stream.py'). The decoder is fed with the received bytes
+ * and writes the pixels into the framebuffer as they arrive, so the packets
+ * are never buffered.
+ *
+ * Each packet has the following format. Multi-byte values are little-endian.
+ *
+ *   Offset  Size  Description
+ *   0       2     Sync bytes, 0xEB 0x50.
+ *   2       1     Packet type, see 'enum EEpdStreamPackets'.
+ *   3       1     Flags, see EPD_STREAM_FLAG_*.
+ *   4       2     Payload size, in bytes.
+ *   6       N     Payload.
+ *   6+N     2     CRC-16/CCITT-FALSE of the type, flags, size and payload.
+ *
+ * The payload of a tile starts with its position and size (4 values of 16
+ * bits), followed by its rows. The payload of a frame only contains the rows
+ * of the whole display. Rows use the framebuffer layout (set bits are white),
+ * each one starting in a new byte, and can be compressed with PackBits as a
+ * whole.
+ *
+ * After each packet, the device replies with EPD_STREAM_ACK, or with
+ * EPD_STREAM_NAK if the packet was invalid. Since pixels are written while the
+ * packet is received, the host must resend a rejected packet before flushing.
+ */
+
+/* Reply bytes */
+#define EPD_STREAM_ACK 0x06
+#define EPD_STREAM_NAK 0x15
+
+/* Payload rows are compressed with PackBits */
+#define EPD_STREAM_FLAG_PACKBITS 0x01
+
+/*
+ * Maximum width of a tile, in pixels. Each row is decoded into a buffer of
+ * this size before being copied into the framebuffer.
+ */
+#define EPD_STREAM_MAX_WIDTH 512
+
+/*
+ * Time without receiving bytes after which a partially received packet is
+ * discarded by 'epd_stream_poll_stdio', in milliseconds.
+ */
+#define EPD_STREAM_TIMEOUT_MS 200
+
+/*
+ * Types of packet.
+ */
+enum EEpdStreamPackets {
+    EPD_STREAM_FRAME = 0x01, /* Rows of the whole framebuffer */
+    EPD_STREAM_TILE  = 0x02, /* Rows of a rectangle */
+    EPD_STREAM_FLUSH = 0x03, /* Call 'epd_flush', without payload */
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_stream epd_stream_t;
+
+/*
+ * Function used for sending the reply to each packet.
+ */
+typedef void (*epd_stream_reply_t)(uint8_t reply);
+
+/*
+ * State of a stream decoder. All members are private.
+ */
+struct epd_stream {
+    epd_ctx_t* ctx;
+    epd_stream_reply_t reply;
+
+    /* Parser state, and the header of the current packet */
+    uint8_t state;
+    uint8_t type, flags;
+    uint16_t size;
+    uint16_t received;
+    uint16_t crc, expected_crc;
+    bool error;
+
+    /* Time at which the last byte was received by 'epd_stream_poll_stdio' */
+    absolute_time_t last_byte;
+
+    /* Position and size of the current tile, and the tile header bytes */
+    uint16_t x, y, width, height;
+    uint8_t tile_header[8];
+
+    /* Row being decoded, and the position of the next byte */
+    uint8_t row[EPD_STREAM_MAX_WIDTH / 8];
+    uint16_t row_pos, row_index;
+
+    /* PackBits state: pending bytes of the run, and whether it repeats */
+    uint16_t run_remaining;
+    bool run_repeat;
+    bool run_header;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Initialize a stream decoder that draws into the specified context. The
+ * 'reply' function can be NULL, and 'epd_stream_reply_stdio' can be used for
+ * replying through the standard output.
+ */
+void epd_stream_init(epd_stream_t* stream,
+                     epd_ctx_t* ctx,
+                     epd_stream_reply_t reply);
+
+/*
+ * Feed received bytes to the decoder. Packets are processed as soon as their
+ * last byte is received.
+ */
+void epd_stream_feed(epd_stream_t* stream, const uint8_t* data, size_t size);
+
+/*
+ * Feed all the bytes that are available in the standard input, without
+ * blocking. With 'pico_enable_stdio_usb', this reads from USB CDC.
+ */
+void epd_stream_poll_stdio(epd_stream_t* stream);
+
+/*
+ * Send a reply byte through the standard output, without newline translation.
+ */
+void epd_stream_reply_stdio(uint8_t reply);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_STREAM_H_ */
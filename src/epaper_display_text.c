@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_text.h"
+
+#include <string.h>
+
+/*
+ * Character used for the ellipsis of truncated lines, and number of times it's
+ * repeated. The built-in font doesn't have U+2026, so three dots are used.
+ */
+#define ELLIPSIS_CHAR  '.'
+#define ELLIPSIS_COUNT 3
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Horizontal advance of a glyph, scaled by the specified text scale.
+ */
+static uint16_t glyph_advance(const epd_font_t* font,
+                              uint16_t scale,
+                              uint32_t codepoint) {
+    const epd_font_glyph_t* glyph = font_get_glyph(font, codepoint);
+    return (glyph == NULL) ? 0 : epd_scale_length(glyph->advance, scale);
+}
+
+/*
+ * Check if the rest of a string only contains spaces and newlines.
+ */
+static bool is_blank(const char* str) {
+    while (*str == ' ' || *str == '\n')
+        str++;
+    return *str == '\0';
+}
+
+/*
+ * Shorten a line so it fits in the box together with the ellipsis, removing
+ * any trailing spaces.
+ */
+static void add_ellipsis(epd_text_layout_t* layout, epd_text_line_t* line) {
+    const epd_font_t* font = layout->font;
+    const uint16_t available =
+      (layout->box_width > layout->ellipsis_width)
+        ? layout->box_width - layout->ellipsis_width
+        : 0;
+
+    const char* start = &layout->str[line->offset];
+    const char* end   = start + line->length;
+    const char* cur   = start;
+
+    const char* content_end = start;
+    uint16_t content_width  = 0;
+    uint16_t width          = 0;
+    while (cur < end) {
+        const uint32_t codepoint = font_utf8_next(&cur);
+        const uint16_t advance =
+          glyph_advance(font, layout->scale, codepoint);
+        if (width + advance > available)
+            break;
+
+        width += advance;
+        if (codepoint != ' ') {
+            content_end   = cur;
+            content_width = width;
+        }
+    }
+
+    line->length   = content_end - start;
+    line->width    = content_width + layout->ellipsis_width;
+    line->ellipsis = true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_measure_str(const epd_ctx_t* ctx,
+                     const char* str,
+                     uint16_t* width,
+                     uint16_t* height) {
+    const epd_font_t* font = ctx->font;
+
+    uint16_t max_width  = 0;
+    uint16_t line_width = 0;
+    uint16_t lines      = (*str == '\0') ? 0 : 1;
+
+    uint32_t codepoint;
+    while ((codepoint = font_utf8_next(&str)) != 0) {
+        if (codepoint == '\n') {
+            lines++;
+            line_width = 0;
+            continue;
+        }
+
+        line_width += glyph_advance(font, ctx->text_scale, codepoint);
+        if (line_width > max_width)
+            max_width = line_width;
+    }
+
+    if (width != NULL)
+        *width = max_width;
+    if (height != NULL)
+        *height = lines * epd_scale_length(font->line_height, ctx->text_scale);
+}
+
+void epd_layout_init(epd_text_layout_t* layout) {
+    memset(layout, 0, sizeof(epd_text_layout_t));
+    layout->valid = false;
+}
+
+bool epd_layout_text(epd_text_layout_t* layout,
+                     const epd_ctx_t* ctx,
+                     const char* str,
+                     uint16_t box_width,
+                     uint16_t box_height,
+                     enum EEpdTextAlign align) {
+    const epd_font_t* font = ctx->font;
+    const uint16_t scale   = ctx->text_scale;
+    const size_t str_len   = strlen(str);
+
+    /*
+     * The text is compared with a copy of the previous one, since it can be in
+     * the same buffer with a different content. Strings longer than the copy
+     * are always laid out again.
+     */
+    const bool copied = str_len <= EPD_TEXT_CACHE_LEN;
+
+    if (layout->valid && copied && layout->str_len == str_len &&
+        memcmp(layout->str_copy, str, str_len) == 0 && layout->font == font && layout->scale == scale &&
+        layout->box_width == box_width && layout->box_height == box_height &&
+        layout->align == align) {
+        /* The text might be the same, but in a different buffer */
+        layout->str = str;
+        return false;
+    }
+
+    layout->str            = str;
+    layout->str_len        = str_len;
+    layout->font           = font;
+    layout->scale          = scale;
+    layout->box_width      = box_width;
+    layout->box_height     = box_height;
+    layout->align          = align;
+    layout->line_count     = 0;
+    layout->line_height    = epd_scale_length(font->line_height, scale);
+    layout->ellipsis_width =
+      ELLIPSIS_COUNT * glyph_advance(font, scale, ELLIPSIS_CHAR);
+    layout->valid          = true;
+    if (copied)
+        memcpy(layout->str_copy, str, str_len);
+
+    /*
+     * Lines that don't fit vertically are never laid out, so they are never
+     * rasterized either.
+     */
+    uint16_t max_lines =
+      (layout->line_height == 0) ? 0 : box_height / layout->line_height;
+    if (max_lines > EPD_TEXT_MAX_LINES)
+        max_lines = EPD_TEXT_MAX_LINES;
+
+    const char* cur = str;
+    while (*cur != '\0' && layout->line_count < max_lines) {
+        const char* line_start = cur;
+
+        /*
+         * End of the last non-space character, and the width up to it. Used
+         * for ignoring trailing spaces.
+         */
+        const char* content_end = cur;
+        uint16_t content_width  = 0;
+
+        /* Last position where the line can be broken, after a word */
+        const char* break_end  = NULL;
+        const char* break_next = NULL;
+        uint16_t break_width   = 0;
+
+        const char* line_end;
+        const char* next;
+        uint16_t line_width;
+        bool wrapped;
+
+        uint16_t width = 0;
+        for (;;) {
+            const char* prev         = cur;
+            const uint32_t codepoint = font_utf8_next(&cur);
+
+            if (codepoint == 0 || codepoint == '\n') {
+                line_end   = content_end;
+                line_width = content_width;
+                next       = cur;
+                wrapped    = false;
+                break;
+            }
+
+            const uint16_t advance = glyph_advance(font, scale, codepoint);
+            if (codepoint == ' ') {
+                if (content_end > line_start) {
+                    break_end   = content_end;
+                    break_width = content_width;
+                    break_next  = cur;
+                }
+                width += advance;
+                continue;
+            }
+
+            /* Always place at least one character in each line */
+            if (width + advance > box_width && content_end > line_start) {
+                if (break_end != NULL) {
+                    line_end   = break_end;
+                    line_width = break_width;
+                    next       = break_next;
+                } else {
+                    line_end   = content_end;
+                    line_width = content_width;
+                    next       = prev;
+                }
+                wrapped = true;
+                break;
+            }
+
+            width += advance;
+            content_end   = cur;
+            content_width = width;
+        }
+
+        epd_text_line_t* line = &layout->lines[layout->line_count++];
+        line->offset          = line_start - str;
+        line->length          = line_end - line_start;
+        line->width           = line_width;
+        line->ellipsis        = false;
+
+        /* Spaces at the start of wrapped lines are not drawn */
+        cur = next;
+        if (wrapped)
+            while (*cur == ' ')
+                cur++;
+    }
+
+    if (layout->line_count > 0 && !is_blank(cur))
+        add_ellipsis(layout, &layout->lines[layout->line_count - 1]);
+
+    for (uint16_t i = 0; i < layout->line_count; i++) {
+        epd_text_line_t* line = &layout->lines[i];
+        const uint16_t space =
+          (box_width > line->width) ? box_width - line->width : 0;
+
+        switch (align) {
+            case EPD_TEXT_ALIGN_LEFT:
+                line->x = 0;
+                break;
+
+            case EPD_TEXT_ALIGN_CENTER:
+                line->x = space / 2;
+                break;
+
+            case EPD_TEXT_ALIGN_RIGHT:
+                line->x = space;
+                break;
+        }
+    }
+
+    return true;
+}
+
+void epd_draw_layout(const epd_ctx_t* ctx,
+                     const epd_text_layout_t* layout,
+                     uint16_t x,
+                     uint16_t y,
+                     uint8_t color) {
+    const epd_font_t* font = layout->font;
+    const uint16_t box_end = x + layout->box_width;
+
+    for (uint16_t i = 0; i < layout->line_count; i++) {
+        const epd_text_line_t* line = &layout->lines[i];
+        const char* cur             = &layout->str[line->offset];
+        const char* end             = cur + line->length;
+        const uint16_t line_y       = y + i * layout->line_height;
+        uint16_t pen_x              = x + line->x;
+
+        while (cur < end) {
+            const uint32_t codepoint      = font_utf8_next(&cur);
+            const epd_font_glyph_t* glyph = font_get_glyph(font, codepoint);
+            if (glyph == NULL)
+                continue;
+
+            /*
+             * Only a single character that is wider than the box can overflow
+             * it. Don't rasterize it.
+             */
+            const uint16_t advance =
+              epd_scale_length(glyph->advance, layout->scale);
+            if (pen_x + advance > box_end)
+                break;
+
+            if (codepoint != ' ')
+                epd_draw_char(ctx, pen_x, line_y, codepoint, color);
+            pen_x += advance;
+        }
+
+        if (line->ellipsis) {
+            const uint16_t advance =
+              glyph_advance(font, layout->scale, ELLIPSIS_CHAR);
+            for (int j = 0; j < ELLIPSIS_COUNT; j++) {
+                epd_draw_char(ctx, pen_x, line_y, ELLIPSIS_CHAR, color);
+                pen_x += advance;
+            }
+        }
+    }
+}
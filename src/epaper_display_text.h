@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_TEXT_H_
+#define EPAPER_DISPLAY_TEXT_H_ 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "epaper_display.h"
+#include "font.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maximum number of lines stored in a text layout. Text that doesn't fit is
+ * truncated with an ellipsis, just like text that doesn't fit in the box.
+ */
+#define EPD_TEXT_MAX_LINES 16
+
+/*
+ * Maximum length in bytes of the strings whose layout can be reused. The text
+ * is copied into the layout, so it can be compared with the next one. Longer
+ * strings are laid out on every call. Can be overridden at compile time.
+ */
+#ifndef EPD_TEXT_CACHE_LEN
+#define EPD_TEXT_CACHE_LEN 256
+#endif
+
+/*
+ * Horizontal alignment of each line inside of a text box.
+ */
+enum EEpdTextAlign {
+    EPD_TEXT_ALIGN_LEFT,
+    EPD_TEXT_ALIGN_CENTER,
+    EPD_TEXT_ALIGN_RIGHT,
+};
+
+/*----------------------------------------------------------------------------*/
+
+typedef struct epd_text_line epd_text_line_t;
+typedef struct epd_text_layout epd_text_layout_t;
+
+/*
+ * Single line of a text layout. The line references a part of the original
+ * string, so it must not be modified or freed while the layout is in use.
+ */
+struct epd_text_line {
+    /* Offset and length of the line inside of the string, in bytes */
+    uint16_t offset, length;
+
+    /* Horizontal position of the line inside of the box, in pixels */
+    uint16_t x;
+
+    /* Width of the line in pixels, including the ellipsis */
+    uint16_t width;
+
+    /* True if an ellipsis should be drawn after the line */
+    bool ellipsis;
+};
+
+/*
+ * Result of laying out a string inside of a box. The inputs of the last layout
+ * are stored, so laying out the same text again returns immediately.
+ */
+struct epd_text_layout {
+    /* Inputs of the last layout */
+    const char* str;
+    size_t str_len;
+    char str_copy[EPD_TEXT_CACHE_LEN];
+    const epd_font_t* font;
+    uint16_t scale;
+    uint16_t box_width, box_height;
+    enum EEpdTextAlign align;
+
+    /* Lines that fit inside of the box */
+    epd_text_line_t lines[EPD_TEXT_MAX_LINES];
+    uint16_t line_count;
+
+    /* Height of the line and width of the ellipsis, in the layout font */
+    uint16_t line_height;
+    uint16_t ellipsis_width;
+
+    /* True if the layout contains the result of a previous call */
+    bool valid;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Measure the size that the specified UTF-8 string would take when drawn with
+ * 'epd_draw_str', using the font and text scale of the context. The width is
+ * the one of the widest line, and the height is the number of lines multiplied
+ * by the line height of the font. Any of the output pointers can be NULL.
+ */
+void epd_measure_str(const epd_ctx_t* ctx,
+                     const char* str,
+                     uint16_t* width,
+                     uint16_t* height);
+
+/*
+ * Initialize an empty text layout. Must be called once before the first
+ * 'epd_layout_text' call with that layout.
+ */
+void epd_layout_init(epd_text_layout_t* layout);
+
+/*
+ * Word-wrap a UTF-8 string inside of a box of the specified dimensions, using
+ * the font and text scale of the context. Lines are broken at spaces when
+ * possible, and at newline characters. Text that doesn't fit in the box is
+ * truncated with an ellipsis.
+ *
+ * If the string, font, scale, box and alignment are the same as in the
+ * previous call, the stored layout is reused. Returns true if the layout was
+ * recomputed.
+ *
+ * The layout of strings longer than EPD_TEXT_CACHE_LEN bytes is never reused.
+ */
+bool epd_layout_text(epd_text_layout_t* layout,
+                     const epd_ctx_t* ctx,
+                     const char* str,
+                     uint16_t box_width,
+                     uint16_t box_height,
+                     enum EEpdTextAlign align);
+
+/*
+ * Draw a text layout with its box at (x, y). The string used for the layout
+ * must still be valid, and the context must still use the font and text scale
+ * of the layout.
+ */
+void epd_draw_layout(const epd_ctx_t* ctx,
+                     const epd_text_layout_t* layout,
+                     uint16_t x,
+                     uint16_t y,
+                     uint8_t color);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_TEXT_H_ */
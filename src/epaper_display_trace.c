@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "epaper_display_trace.h"
+
+#ifdef EPD_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#if EPD_TRACE_RECORDS > 0xFFFF || EPD_TRACE_DATA_BYTES > 0xFF
+#error "The trace record count or size doesn't fit in the export format."
+#endif
+
+/* Size of the export header, and of a record without its bytes */
+#define TRACE_HEADER_SIZE 12
+#define TRACE_RECORD_SIZE 12
+
+typedef struct {
+    uint32_t start_us;
+    uint32_t duration_us;
+    uint16_t length;
+    uint8_t type;
+    uint8_t count;
+    uint8_t data[EPD_TRACE_DATA_BYTES];
+} trace_record_t;
+
+/*
+ * Ring buffer of records. The oldest one is at 'trace_first', and the number
+ * of records lost since the last clear is 'trace_lost'.
+ */
+static trace_record_t trace_records[EPD_TRACE_RECORDS];
+static size_t trace_first = 0;
+static size_t trace_count = 0;
+static uint32_t trace_lost = 0;
+
+/*
+ * Function that receives the exported bytes, and its argument.
+ */
+typedef void (*trace_writer_t)(const uint8_t* data, size_t len, void* arg);
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint8_t* trace_put_u16(uint8_t* dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+    return dst + 2;
+}
+
+static inline uint8_t* trace_put_u32(uint8_t* dst, uint32_t value) {
+    dst = trace_put_u16(dst, value & 0xFFFF);
+    return trace_put_u16(dst, value >> 16);
+}
+
+/*
+ * Serialize the trace, passing the header and each record to 'write'.
+ */
+static void trace_write(trace_writer_t write, void* arg) {
+    uint8_t header[TRACE_HEADER_SIZE] = { 'E', 'P', 'D', 'T' };
+    uint8_t* dst = &header[4];
+    *dst++       = EPD_TRACE_VERSION;
+    *dst++       = EPD_TRACE_DATA_BYTES;
+    dst          = trace_put_u16(dst, trace_count);
+    trace_put_u32(dst, trace_lost);
+    write(header, sizeof(header), arg);
+
+    for (size_t i = 0; i < trace_count; i++) {
+        const trace_record_t* record =
+          &trace_records[(trace_first + i) % EPD_TRACE_RECORDS];
+
+        uint8_t bytes[TRACE_RECORD_SIZE + EPD_TRACE_DATA_BYTES];
+        dst    = trace_put_u32(bytes, record->start_us);
+        dst    = trace_put_u32(dst, record->duration_us);
+        dst    = trace_put_u16(dst, record->length);
+        *dst++ = record->type;
+        *dst++ = record->count;
+        memcpy(dst, record->data, record->count);
+        write(bytes, TRACE_RECORD_SIZE + record->count, arg);
+    }
+}
+
+/*
+ * Writer for 'epd_trace_export', which copies the bytes to a buffer.
+ */
+typedef struct {
+    uint8_t* buffer;
+    size_t used;
+} trace_buffer_t;
+
+static void trace_write_buffer(const uint8_t* data, size_t len, void* arg) {
+    trace_buffer_t* out = arg;
+    memcpy(&out->buffer[out->used], data, len);
+    out->used += len;
+}
+
+static void trace_write_stdio(const uint8_t* data, size_t len, void* arg) {
+    (void)arg;
+    for (size_t i = 0; i < len; i++)
+        putchar_raw(data[i]);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void epd_trace_record(enum EEpdTraceTypes type,
+                      uint32_t start_us,
+                      const uint8_t* data,
+                      size_t len) {
+    const uint32_t end_us = time_us_32();
+
+    trace_record_t* record;
+    if (trace_count < EPD_TRACE_RECORDS) {
+        record = &trace_records[(trace_first + trace_count++) %
+                                EPD_TRACE_RECORDS];
+    } else {
+        /* Overwrite the oldest record */
+        record      = &trace_records[trace_first];
+        trace_first = (trace_first + 1) % EPD_TRACE_RECORDS;
+        trace_lost++;
+    }
+
+    record->start_us    = start_us;
+    record->duration_us = end_us - start_us;
+    record->length      = (len > 0xFFFF) ? 0xFFFF : len;
+    record->type        = type;
+    record->count = (len > EPD_TRACE_DATA_BYTES) ? EPD_TRACE_DATA_BYTES : len;
+    if (record->count > 0)
+        memcpy(record->data, data, record->count);
+}
+
+void epd_trace_clear(void) {
+    trace_first = 0;
+    trace_count = 0;
+    trace_lost  = 0;
+}
+
+size_t epd_trace_export(uint8_t* buffer, size_t size) {
+    size_t needed = TRACE_HEADER_SIZE;
+    for (size_t i = 0; i < trace_count; i++)
+        needed += TRACE_RECORD_SIZE +
+                  trace_records[(trace_first + i) % EPD_TRACE_RECORDS].count;
+
+    if (buffer == NULL)
+        return needed;
+    if (size < needed)
+        return 0;
+
+    trace_buffer_t out = { buffer, 0 };
+    trace_write(trace_write_buffer, &out);
+    return out.used;
+}
+
+void epd_trace_dump(void) {
+    trace_write(trace_write_stdio, NULL);
+    stdio_flush();
+}
+
+#endif /* EPD_TRACE */
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 8dcc
+ *
+ * This file is part of rp2350-epaper.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EPAPER_DISPLAY_TRACE_H_
+#define EPAPER_DISPLAY_TRACE_H_ 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef EPD_TRACE
+#include "pico/time.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Trace of the transactions sent to the display, for finding out what the
+ * driver actually sent, and where the time of a refresh went. It's only
+ * compiled if EPD_TRACE is defined (with the EPD_TRACE option of CMake);
+ * otherwise, the instrumentation of 'epaper_display_utils.c' expands to
+ * nothing, and the functions below do nothing.
+ *
+ * Each command, data transfer and wait for the BUSY pin is stored in a ring
+ * buffer of EPD_TRACE_RECORDS entries, overwriting the oldest ones when full.
+ * The trace can be exported in a binary format, which is decoded by
+ * 'tools/epd_trace.py'.
+ */
+#ifndef EPD_TRACE_RECORDS
+#define EPD_TRACE_RECORDS 256
+#endif
+
+/*
+ * Number of bytes of each transaction stored in its record.
+ */
+#ifndef EPD_TRACE_DATA_BYTES
+#define EPD_TRACE_DATA_BYTES 8
+#endif
+
+/*
+ * Types of trace records. Commands are sent with the DC pin low, and data with
+ * the DC pin high.
+ */
+enum EEpdTraceTypes {
+    EPD_TRACE_COMMAND,
+    EPD_TRACE_DATA,
+    EPD_TRACE_BUSY,
+};
+
+/*
+ * Version of the export format, stored in its header.
+ */
+#define EPD_TRACE_VERSION 1
+
+#ifdef EPD_TRACE
+
+/*
+ * Store a record of the specified type, which started at 'start_us' (from
+ * 'time_us_32') and ended now. The first bytes of 'data' are stored.
+ */
+void epd_trace_record(enum EEpdTraceTypes type,
+                      uint32_t start_us,
+                      const uint8_t* data,
+                      size_t len);
+
+/*
+ * Remove all records.
+ */
+void epd_trace_clear(void);
+
+/*
+ * Write the trace into 'buffer', with the format described below. Returns the
+ * number of bytes written, or zero if the buffer is too small. If 'buffer' is
+ * NULL, returns the size of the trace instead.
+ *
+ * All values are little-endian. The header contains:
+ *
+ *   - The magic "EPDT" (4 bytes).
+ *   - EPD_TRACE_VERSION (1 byte).
+ *   - EPD_TRACE_DATA_BYTES (1 byte).
+ *   - Number of records (2 bytes).
+ *   - Number of records lost because the buffer was full (4 bytes).
+ *
+ * It's followed by the records, from the oldest one:
+ *
+ *   - Start time in microseconds, from 'time_us_32' (4 bytes).
+ *   - Duration in microseconds (4 bytes).
+ *   - Length of the transaction in bytes, saturated to 0xFFFF (2 bytes).
+ *   - Type, from 'EEpdTraceTypes' (1 byte).
+ *   - Number of stored bytes N (1 byte).
+ *   - The first N bytes of the transaction.
+ */
+size_t epd_trace_export(uint8_t* buffer, size_t size);
+
+/*
+ * Write the trace through stdio, in the same format as 'epd_trace_export'.
+ * The bytes are written raw, so the output can be captured from USB CDC. Other
+ * output before and after it is skipped by 'tools/epd_trace.py'.
+ */
+void epd_trace_dump(void);
+
+/*
+ * Measure the transaction between these two macros, which must be in the same
+ * scope, and store its record.
+ */
+#define EPD_TRACE_BEGIN() const uint32_t epd_trace_start = time_us_32()
+#define EPD_TRACE_END(TYPE, DATA, LEN)                                         \
+    epd_trace_record((TYPE), epd_trace_start, (DATA), (LEN))
+
+#else /* !EPD_TRACE */
+
+static inline void epd_trace_clear(void) {}
+static inline size_t epd_trace_export(uint8_t* buffer, size_t size) {
+    (void)buffer;
+    (void)size;
+    return 0;
+}
+static inline void epd_trace_dump(void) {}
+
+#define EPD_TRACE_BEGIN()                                                      \
+    do {                                                                       \
+    } while (0)
+#define EPD_TRACE_END(TYPE, DATA, LEN)                                         \
+    do {                                                                       \
+    } while (0)
+
+#endif /* !EPD_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPAPER_DISPLAY_TRACE_H_ */
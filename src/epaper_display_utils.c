@@ -19,9 +19,68 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
 #include "hardware/spi.h"
+#include "hardware/sync.h"
 
 #include "epaper_display.h"
+#include "epaper_display_trace.h"
+
+/*
+ * BUSY pin being waited for by 'utils_wait_sleep', and whether it fell.
+ */
+static uint8_t wait_busy_pin;
+static volatile bool wait_busy_fell;
+
+/*----------------------------------------------------------------------------*/
+
+static void utils_busy_irq_handler(void) {
+    if ((gpio_get_irq_event_mask(wait_busy_pin) & GPIO_IRQ_EDGE_FALL) == 0)
+        return;
+
+    gpio_acknowledge_irq(wait_busy_pin, GPIO_IRQ_EDGE_FALL);
+    wait_busy_fell = true;
+    __sev();
+}
+
+/*
+ * Wait until the display is idle, sleeping the core between interrupts.
+ */
+static void utils_wait_sleep(const epd_ctx_t* ctx) {
+    const uint8_t pin = ctx->pins.busy;
+
+    wait_busy_pin  = pin;
+    wait_busy_fell = false;
+    gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_FALL);
+    gpio_add_raw_irq_handler(pin, utils_busy_irq_handler);
+    gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    /* The clock is lowered after enabling the interrupt, so no edge is lost */
+    const uint32_t saved_khz = clock_get_hz(clk_sys) / 1000;
+    const bool lowered =
+      ctx->wait_clock_khz != 0 && ctx->wait_clock_khz < saved_khz &&
+      set_sys_clock_khz(ctx->wait_clock_khz, false);
+
+    /*
+     * If the edge occurs between the check and '__wfe', the event set by the
+     * handler makes '__wfe' return immediately. Other interrupts also wake the
+     * core, giving the idle hook a chance to run.
+     */
+    while (!wait_busy_fell && gpio_get(pin) == 1) {
+        if (ctx->idle_hook != NULL && ctx->idle_hook(ctx->idle_hook_data))
+            continue;
+        __wfe();
+    }
+
+    if (lowered)
+        set_sys_clock_khz(saved_khz, true);
+
+    gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_FALL, false);
+    gpio_remove_raw_irq_handler(pin, utils_busy_irq_handler);
+}
 
 void epd_utils_spi_write(const epd_ctx_t* ctx,
                          const uint8_t* data,
@@ -32,23 +91,38 @@ void epd_utils_spi_write(const epd_ctx_t* ctx,
 }
 
 void epd_utils_send_command(const epd_ctx_t* ctx, uint8_t cmd) {
+    EPD_TRACE_BEGIN();
     gpio_put(ctx->pins.dc, 0);
     epd_utils_spi_write(ctx, &cmd, 1);
+    EPD_TRACE_END(EPD_TRACE_COMMAND, &cmd, 1);
 }
 
 void epd_utils_send_data(const epd_ctx_t* ctx, uint8_t data) {
+    EPD_TRACE_BEGIN();
     gpio_put(ctx->pins.dc, 1);
     epd_utils_spi_write(ctx, &data, 1);
+    EPD_TRACE_END(EPD_TRACE_DATA, &data, 1);
 }
 
 void epd_utils_send_data_buffer(const epd_ctx_t* ctx,
                                 const uint8_t* data,
                                 size_t len) {
+    EPD_TRACE_BEGIN();
     gpio_put(ctx->pins.dc, 1);
     epd_utils_spi_write(ctx, data, len);
+    EPD_TRACE_END(EPD_TRACE_DATA, data, len);
 }
 
 void epd_utils_wait_until_idle(const epd_ctx_t* ctx) {
-    while (gpio_get(ctx->pins.busy) == 1)
-        sleep_ms(10);
+    EPD_TRACE_BEGIN();
+
+    if (ctx->wait_mode == EPD_WAIT_SLEEP) {
+        utils_wait_sleep(ctx);
+    } else {
+        while (gpio_get(ctx->pins.busy) == 1)
+            if (ctx->idle_hook == NULL || !ctx->idle_hook(ctx->idle_hook_data))
+                sleep_ms(1);
+    }
+
+    EPD_TRACE_END(EPD_TRACE_BUSY, NULL, 0);
 }
@@ -24,6 +24,10 @@
 
 #include "epaper_display.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*
  * Log a message to standard output.
  */
@@ -66,8 +70,13 @@ void epd_utils_send_data_buffer(const epd_ctx_t* ctx,
 
 /*
  * Wait until the display associated to the specified E-Paper Display context is
- * no longer busy. That is, while the stored "busy" pin is 1.
+ * no longer busy. That is, while the stored "busy" pin is 1. The core waits as
+ * specified by the 'wait_mode' of the context, calling its idle hook.
  */
 void epd_utils_wait_until_idle(const epd_ctx_t* ctx);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* EPAPER_DISPLAY_UTILS_H_ */
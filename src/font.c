@@ -17,108 +17,441 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include "font.h"
 
-static const uint8_t font[][FONT_HEIGHT] = {
-    { 0x00, 0x00, 0x00, 0x00, 0x00 }, /* space */
-    { 0x00, 0x00, 0x5F, 0x00, 0x00 }, /* ! */
-    { 0x00, 0x07, 0x00, 0x07, 0x00 }, /* " */
-    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, /* # */
-    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, /* $ */
-    { 0x23, 0x13, 0x08, 0x64, 0x62 }, /* % */
-    { 0x36, 0x49, 0x55, 0x22, 0x50 }, /* & */
-    { 0x00, 0x05, 0x03, 0x00, 0x00 }, /* ' */
-    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, /* ( */
-    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, /* ) */
-    { 0x14, 0x08, 0x3E, 0x08, 0x14 }, /* * */
-    { 0x08, 0x08, 0x3E, 0x08, 0x08 }, /* + */
-    { 0x00, 0x50, 0x30, 0x00, 0x00 }, /* , */
-    { 0x08, 0x08, 0x08, 0x08, 0x08 }, /* - */
-    { 0x00, 0x60, 0x60, 0x00, 0x00 }, /* . */
-    { 0x20, 0x10, 0x08, 0x04, 0x02 }, /* / */
-    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, /* 0 */
-    { 0x00, 0x42, 0x7F, 0x40, 0x00 }, /* 1 */
-    { 0x42, 0x61, 0x51, 0x49, 0x46 }, /* 2 */
-    { 0x21, 0x41, 0x45, 0x4B, 0x31 }, /* 3 */
-    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, /* 4 */
-    { 0x27, 0x45, 0x45, 0x45, 0x39 }, /* 5 */
-    { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, /* 6 */
-    { 0x01, 0x71, 0x09, 0x05, 0x03 }, /* 7 */
-    { 0x36, 0x49, 0x49, 0x49, 0x36 }, /* 8 */
-    { 0x06, 0x49, 0x49, 0x29, 0x1E }, /* 9 */
-    { 0x00, 0x36, 0x36, 0x00, 0x00 }, /* : */
-    { 0x00, 0x56, 0x36, 0x00, 0x00 }, /* ; */
-    { 0x08, 0x14, 0x22, 0x41, 0x00 }, /* < */
-    { 0x14, 0x14, 0x14, 0x14, 0x14 }, /* = */
-    { 0x00, 0x41, 0x22, 0x14, 0x08 }, /* > */
-    { 0x02, 0x01, 0x51, 0x09, 0x06 }, /* ? */
-    { 0x32, 0x49, 0x79, 0x41, 0x3E }, /* @ */
-    { 0x7E, 0x11, 0x11, 0x11, 0x7E }, /* A */
-    { 0x7F, 0x49, 0x49, 0x49, 0x36 }, /* B */
-    { 0x3E, 0x41, 0x41, 0x41, 0x22 }, /* C */
-    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, /* D */
-    { 0x7F, 0x49, 0x49, 0x49, 0x41 }, /* E */
-    { 0x7F, 0x09, 0x09, 0x09, 0x01 }, /* F */
-    { 0x3E, 0x41, 0x49, 0x49, 0x7A }, /* G */
-    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, /* H */
-    { 0x00, 0x41, 0x7F, 0x41, 0x00 }, /* I */
-    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, /* J */
-    { 0x7F, 0x08, 0x14, 0x22, 0x41 }, /* K */
-    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, /* L */
-    { 0x7F, 0x02, 0x0C, 0x02, 0x7F }, /* M */
-    { 0x7F, 0x04, 0x08, 0x10, 0x7F }, /* N */
-    { 0x3E, 0x41, 0x41, 0x41, 0x3E }, /* O */
-    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, /* P */
-    { 0x3E, 0x41, 0x51, 0x21, 0x5E }, /* Q */
-    { 0x7F, 0x09, 0x19, 0x29, 0x46 }, /* R */
-    { 0x46, 0x49, 0x49, 0x49, 0x31 }, /* S */
-    { 0x01, 0x01, 0x7F, 0x01, 0x01 }, /* T */
-    { 0x3F, 0x40, 0x40, 0x40, 0x3F }, /* U */
-    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, /* V */
-    { 0x3F, 0x40, 0x38, 0x40, 0x3F }, /* W */
-    { 0x63, 0x14, 0x08, 0x14, 0x63 }, /* X */
-    { 0x07, 0x08, 0x70, 0x08, 0x07 }, /* Y */
-    { 0x61, 0x51, 0x49, 0x45, 0x43 }, /* Z */
-    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, /* [ */
-    { 0x02, 0x04, 0x08, 0x10, 0x20 }, /* \ */
-    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, /* ] */
-    { 0x04, 0x02, 0x01, 0x02, 0x04 }, /* ^ */
-    { 0x40, 0x40, 0x40, 0x40, 0x40 }, /* _ */
-    { 0x00, 0x01, 0x02, 0x04, 0x00 }, /* ` */
-    { 0x20, 0x54, 0x54, 0x54, 0x78 }, /* a */
-    { 0x7F, 0x48, 0x44, 0x44, 0x38 }, /* b */
-    { 0x38, 0x44, 0x44, 0x44, 0x20 }, /* c */
-    { 0x38, 0x44, 0x44, 0x48, 0x7F }, /* d */
-    { 0x38, 0x54, 0x54, 0x54, 0x18 }, /* e */
-    { 0x08, 0x7E, 0x09, 0x01, 0x02 }, /* f */
-    { 0x0C, 0x52, 0x52, 0x52, 0x3E }, /* g */
-    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, /* h */
-    { 0x00, 0x44, 0x7D, 0x40, 0x00 }, /* i */
-    { 0x20, 0x40, 0x44, 0x3D, 0x00 }, /* j */
-    { 0x7F, 0x10, 0x28, 0x44, 0x00 }, /* k */
-    { 0x00, 0x41, 0x7F, 0x40, 0x00 }, /* l */
-    { 0x7C, 0x04, 0x18, 0x04, 0x78 }, /* m */
-    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, /* n */
-    { 0x38, 0x44, 0x44, 0x44, 0x38 }, /* o */
-    { 0x7C, 0x14, 0x14, 0x14, 0x08 }, /* p */
-    { 0x08, 0x14, 0x14, 0x18, 0x7C }, /* q */
-    { 0x7C, 0x08, 0x04, 0x04, 0x08 }, /* r */
-    { 0x48, 0x54, 0x54, 0x54, 0x20 }, /* s */
-    { 0x04, 0x3F, 0x44, 0x40, 0x20 }, /* t */
-    { 0x3C, 0x40, 0x40, 0x20, 0x7C }, /* u */
-    { 0x1C, 0x20, 0x40, 0x20, 0x1C }, /* v */
-    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, /* w */
-    { 0x44, 0x28, 0x10, 0x28, 0x44 }, /* x */
-    { 0x0C, 0x50, 0x50, 0x50, 0x3C }, /* y */
-    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, /* z */
+/*
+ * Bitmap data of the built-in font. Each glyph takes one byte per row.
+ */
+static const uint8_t font_5x7_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,            /* space */
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20,            /* ! */
+    0x50, 0x50, 0x50, 0x00, 0x00, 0x00, 0x00,            /* " */
+    0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50,            /* # */
+    0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20,            /* $ */
+    0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18,            /* % */
+    0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68,            /* & */
+    0x60, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00,            /* ' */
+    0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10,            /* ( */
+    0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40,            /* ) */
+    0x00, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x00,            /* '*' */
+    0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00,            /* + */
+    0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40,            /* , */
+    0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00,            /* - */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60,            /* . */
+    0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00,            /* '/' */
+    0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70,            /* 0 */
+    0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70,            /* 1 */
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8,            /* 2 */
+    0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70,            /* 3 */
+    0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10,            /* 4 */
+    0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70,            /* 5 */
+    0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70,            /* 6 */
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40,            /* 7 */
+    0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70,            /* 8 */
+    0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60,            /* 9 */
+    0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00,            /* : */
+    0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40,            /* ; */
+    0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10,            /* < */
+    0x00, 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00,            /* = */
+    0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40,            /* > */
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20,            /* ? */
+    0x70, 0x88, 0x08, 0x68, 0xA8, 0xA8, 0x70,            /* @ */
+    0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88,            /* A */
+    0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0,            /* B */
+    0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70,            /* C */
+    0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0,            /* D */
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8,            /* E */
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80,            /* F */
+    0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78,            /* G */
+    0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88,            /* H */
+    0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70,            /* I */
+    0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60,            /* J */
+    0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88,            /* K */
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8,            /* L */
+    0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88,            /* M */
+    0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88,            /* N */
+    0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70,            /* O */
+    0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80,            /* P */
+    0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68,            /* Q */
+    0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88,            /* R */
+    0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0,            /* S */
+    0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,            /* T */
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70,            /* U */
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20,            /* V */
+    0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50,            /* W */
+    0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88,            /* X */
+    0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20,            /* Y */
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8,            /* Z */
+    0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10,            /* [ */
+    0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00,            /* \ */
+    0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40,            /* ] */
+    0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00,            /* ^ */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8,            /* _ */
+    0x40, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00,            /* ` */
+    0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78,            /* a */
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0,            /* b */
+    0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70,            /* c */
+    0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78,            /* d */
+    0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70,            /* e */
+    0x30, 0x48, 0x40, 0xE0, 0x40, 0x40, 0x40,            /* f */
+    0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70,            /* g */
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88,            /* h */
+    0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70,            /* i */
+    0x10, 0x00, 0x30, 0x10, 0x10, 0x90, 0x60,            /* j */
+    0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90,            /* k */
+    0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70,            /* l */
+    0x00, 0x00, 0xD0, 0xA8, 0xA8, 0x88, 0x88,            /* m */
+    0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88,            /* n */
+    0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70,            /* o */
+    0x00, 0x00, 0xF0, 0x88, 0xF0, 0x80, 0x80,            /* p */
+    0x00, 0x00, 0x68, 0x98, 0x78, 0x08, 0x08,            /* q */
+    0x00, 0x00, 0xB0, 0xC8, 0x80, 0x80, 0x80,            /* r */
+    0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xF0,            /* s */
+    0x40, 0x40, 0xE0, 0x40, 0x40, 0x48, 0x30,            /* t */
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68,            /* u */
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20,            /* v */
+    0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50,            /* w */
+    0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88,            /* x */
+    0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70,            /* y */
+    0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8,            /* z */
+    0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10,            /* { */
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,            /* | */
+    0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40,            /* } */
+    0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00,            /* ~ */
+    0x20, 0x00, 0x20, 0x20, 0x20, 0x20, 0x20,            /* U+00A1 */
+    0x60, 0x90, 0x90, 0x60,                              /* U+00B0 */
+    0x00, 0x00, 0x90, 0x90, 0x90, 0xE8, 0x80,            /* U+00B5 */
+    0x20, 0x00, 0x20, 0x40, 0x80, 0x88, 0x70,            /* U+00BF */
+    0x40, 0x20, 0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, /* U+00C0 */
+    0x10, 0x20, 0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, /* U+00C1 */
+    0x20, 0x50, 0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, /* U+00C2 */
+    0x50, 0xA0, 0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, /* U+00C3 */
+    0x50, 0x00, 0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, /* U+00C4 */
+    0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x20, 0x40, /* U+00C7 */
+    0x40, 0x20, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, /* U+00C8 */
+    0x10, 0x20, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, /* U+00C9 */
+    0x20, 0x50, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, /* U+00CA */
+    0x50, 0x00, 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, /* U+00CB */
+    0x40, 0x20, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, /* U+00CC */
+    0x10, 0x20, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, /* U+00CD */
+    0x20, 0x50, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, /* U+00CE */
+    0x50, 0x00, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, /* U+00CF */
+    0x50, 0xA0, 0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, /* U+00D1 */
+    0x40, 0x20, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D2 */
+    0x10, 0x20, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D3 */
+    0x20, 0x50, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D4 */
+    0x50, 0xA0, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D5 */
+    0x50, 0x00, 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D6 */
+    0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00,            /* U+00D7 */
+    0x40, 0x20, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00D9 */
+    0x10, 0x20, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00DA */
+    0x20, 0x50, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00DB */
+    0x50, 0x00, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, /* U+00DC */
+    0x10, 0x20, 0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20, /* U+00DD */
+    0x60, 0x90, 0xA0, 0x90, 0x88, 0x88, 0xB0,            /* U+00DF */
+    0x80, 0x40, 0x70, 0x08, 0x78, 0x88, 0x78,            /* U+00E0 */
+    0x10, 0x20, 0x70, 0x08, 0x78, 0x88, 0x78,            /* U+00E1 */
+    0x20, 0x50, 0x70, 0x08, 0x78, 0x88, 0x78,            /* U+00E2 */
+    0x50, 0xA0, 0x70, 0x08, 0x78, 0x88, 0x78,            /* U+00E3 */
+    0x50, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78,            /* U+00E4 */
+    0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, 0x20, 0x40, /* U+00E7 */
+    0x80, 0x40, 0x70, 0x88, 0xF8, 0x80, 0x70,            /* U+00E8 */
+    0x10, 0x20, 0x70, 0x88, 0xF8, 0x80, 0x70,            /* U+00E9 */
+    0x20, 0x50, 0x70, 0x88, 0xF8, 0x80, 0x70,            /* U+00EA */
+    0x50, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70,            /* U+00EB */
+    0x80, 0x40, 0x60, 0x20, 0x20, 0x20, 0x70,            /* U+00EC */
+    0x10, 0x20, 0x60, 0x20, 0x20, 0x20, 0x70,            /* U+00ED */
+    0x20, 0x50, 0x60, 0x20, 0x20, 0x20, 0x70,            /* U+00EE */
+    0x50, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70,            /* U+00EF */
+    0x50, 0xA0, 0xB0, 0xC8, 0x88, 0x88, 0x88,            /* U+00F1 */
+    0x80, 0x40, 0x70, 0x88, 0x88, 0x88, 0x70,            /* U+00F2 */
+    0x10, 0x20, 0x70, 0x88, 0x88, 0x88, 0x70,            /* U+00F3 */
+    0x20, 0x50, 0x70, 0x88, 0x88, 0x88, 0x70,            /* U+00F4 */
+    0x50, 0xA0, 0x70, 0x88, 0x88, 0x88, 0x70,            /* U+00F5 */
+    0x50, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70,            /* U+00F6 */
+    0x80, 0x40, 0x88, 0x88, 0x88, 0x98, 0x68,            /* U+00F9 */
+    0x10, 0x20, 0x88, 0x88, 0x88, 0x98, 0x68,            /* U+00FA */
+    0x20, 0x50, 0x88, 0x88, 0x88, 0x98, 0x68,            /* U+00FB */
+    0x50, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68,            /* U+00FC */
+    0x10, 0x20, 0x88, 0x88, 0x78, 0x08, 0x70,            /* U+00FD */
+    0x50, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70,            /* U+00FF */
+    0x38, 0x40, 0xF0, 0x40, 0xF0, 0x40, 0x38,            /* U+20AC */
+};
+
+/*
+ * Glyphs of the built-in font. Capital letters with accents extend two rows
+ * above the line, and the cedilla two rows below it.
+ */
+static const epd_font_glyph_t font_5x7_glyphs[] = {
+    {    0, 5, 7, 0,  0, 6 }, /* space */
+    {    7, 5, 7, 0,  0, 6 }, /* ! */
+    {   14, 5, 7, 0,  0, 6 }, /* " */
+    {   21, 5, 7, 0,  0, 6 }, /* # */
+    {   28, 5, 7, 0,  0, 6 }, /* $ */
+    {   35, 5, 7, 0,  0, 6 }, /* % */
+    {   42, 5, 7, 0,  0, 6 }, /* & */
+    {   49, 5, 7, 0,  0, 6 }, /* ' */
+    {   56, 5, 7, 0,  0, 6 }, /* ( */
+    {   63, 5, 7, 0,  0, 6 }, /* ) */
+    {   70, 5, 7, 0,  0, 6 }, /* '*' */
+    {   77, 5, 7, 0,  0, 6 }, /* + */
+    {   84, 5, 7, 0,  0, 6 }, /* , */
+    {   91, 5, 7, 0,  0, 6 }, /* - */
+    {   98, 5, 7, 0,  0, 6 }, /* . */
+    {  105, 5, 7, 0,  0, 6 }, /* '/' */
+    {  112, 5, 7, 0,  0, 6 }, /* 0 */
+    {  119, 5, 7, 0,  0, 6 }, /* 1 */
+    {  126, 5, 7, 0,  0, 6 }, /* 2 */
+    {  133, 5, 7, 0,  0, 6 }, /* 3 */
+    {  140, 5, 7, 0,  0, 6 }, /* 4 */
+    {  147, 5, 7, 0,  0, 6 }, /* 5 */
+    {  154, 5, 7, 0,  0, 6 }, /* 6 */
+    {  161, 5, 7, 0,  0, 6 }, /* 7 */
+    {  168, 5, 7, 0,  0, 6 }, /* 8 */
+    {  175, 5, 7, 0,  0, 6 }, /* 9 */
+    {  182, 5, 7, 0,  0, 6 }, /* : */
+    {  189, 5, 7, 0,  0, 6 }, /* ; */
+    {  196, 5, 7, 0,  0, 6 }, /* < */
+    {  203, 5, 7, 0,  0, 6 }, /* = */
+    {  210, 5, 7, 0,  0, 6 }, /* > */
+    {  217, 5, 7, 0,  0, 6 }, /* ? */
+    {  224, 5, 7, 0,  0, 6 }, /* @ */
+    {  231, 5, 7, 0,  0, 6 }, /* A */
+    {  238, 5, 7, 0,  0, 6 }, /* B */
+    {  245, 5, 7, 0,  0, 6 }, /* C */
+    {  252, 5, 7, 0,  0, 6 }, /* D */
+    {  259, 5, 7, 0,  0, 6 }, /* E */
+    {  266, 5, 7, 0,  0, 6 }, /* F */
+    {  273, 5, 7, 0,  0, 6 }, /* G */
+    {  280, 5, 7, 0,  0, 6 }, /* H */
+    {  287, 5, 7, 0,  0, 6 }, /* I */
+    {  294, 5, 7, 0,  0, 6 }, /* J */
+    {  301, 5, 7, 0,  0, 6 }, /* K */
+    {  308, 5, 7, 0,  0, 6 }, /* L */
+    {  315, 5, 7, 0,  0, 6 }, /* M */
+    {  322, 5, 7, 0,  0, 6 }, /* N */
+    {  329, 5, 7, 0,  0, 6 }, /* O */
+    {  336, 5, 7, 0,  0, 6 }, /* P */
+    {  343, 5, 7, 0,  0, 6 }, /* Q */
+    {  350, 5, 7, 0,  0, 6 }, /* R */
+    {  357, 5, 7, 0,  0, 6 }, /* S */
+    {  364, 5, 7, 0,  0, 6 }, /* T */
+    {  371, 5, 7, 0,  0, 6 }, /* U */
+    {  378, 5, 7, 0,  0, 6 }, /* V */
+    {  385, 5, 7, 0,  0, 6 }, /* W */
+    {  392, 5, 7, 0,  0, 6 }, /* X */
+    {  399, 5, 7, 0,  0, 6 }, /* Y */
+    {  406, 5, 7, 0,  0, 6 }, /* Z */
+    {  413, 5, 7, 0,  0, 6 }, /* [ */
+    {  420, 5, 7, 0,  0, 6 }, /* \ */
+    {  427, 5, 7, 0,  0, 6 }, /* ] */
+    {  434, 5, 7, 0,  0, 6 }, /* ^ */
+    {  441, 5, 7, 0,  0, 6 }, /* _ */
+    {  448, 5, 7, 0,  0, 6 }, /* ` */
+    {  455, 5, 7, 0,  0, 6 }, /* a */
+    {  462, 5, 7, 0,  0, 6 }, /* b */
+    {  469, 5, 7, 0,  0, 6 }, /* c */
+    {  476, 5, 7, 0,  0, 6 }, /* d */
+    {  483, 5, 7, 0,  0, 6 }, /* e */
+    {  490, 5, 7, 0,  0, 6 }, /* f */
+    {  497, 5, 7, 0,  0, 6 }, /* g */
+    {  504, 5, 7, 0,  0, 6 }, /* h */
+    {  511, 5, 7, 0,  0, 6 }, /* i */
+    {  518, 5, 7, 0,  0, 6 }, /* j */
+    {  525, 5, 7, 0,  0, 6 }, /* k */
+    {  532, 5, 7, 0,  0, 6 }, /* l */
+    {  539, 5, 7, 0,  0, 6 }, /* m */
+    {  546, 5, 7, 0,  0, 6 }, /* n */
+    {  553, 5, 7, 0,  0, 6 }, /* o */
+    {  560, 5, 7, 0,  0, 6 }, /* p */
+    {  567, 5, 7, 0,  0, 6 }, /* q */
+    {  574, 5, 7, 0,  0, 6 }, /* r */
+    {  581, 5, 7, 0,  0, 6 }, /* s */
+    {  588, 5, 7, 0,  0, 6 }, /* t */
+    {  595, 5, 7, 0,  0, 6 }, /* u */
+    {  602, 5, 7, 0,  0, 6 }, /* v */
+    {  609, 5, 7, 0,  0, 6 }, /* w */
+    {  616, 5, 7, 0,  0, 6 }, /* x */
+    {  623, 5, 7, 0,  0, 6 }, /* y */
+    {  630, 5, 7, 0,  0, 6 }, /* z */
+    {  637, 5, 7, 0,  0, 6 }, /* { */
+    {  644, 5, 7, 0,  0, 6 }, /* | */
+    {  651, 5, 7, 0,  0, 6 }, /* } */
+    {  658, 5, 7, 0,  0, 6 }, /* ~ */
+    {  665, 5, 7, 0,  0, 6 }, /* U+00A1 */
+    {  672, 5, 4, 0,  0, 6 }, /* U+00B0 */
+    {  676, 5, 7, 0,  0, 6 }, /* U+00B5 */
+    {  683, 5, 7, 0,  0, 6 }, /* U+00BF */
+    {  690, 5, 9, 0, -2, 6 }, /* U+00C0 */
+    {  699, 5, 9, 0, -2, 6 }, /* U+00C1 */
+    {  708, 5, 9, 0, -2, 6 }, /* U+00C2 */
+    {  717, 5, 9, 0, -2, 6 }, /* U+00C3 */
+    {  726, 5, 9, 0, -2, 6 }, /* U+00C4 */
+    {  735, 5, 9, 0,  0, 6 }, /* U+00C7 */
+    {  744, 5, 9, 0, -2, 6 }, /* U+00C8 */
+    {  753, 5, 9, 0, -2, 6 }, /* U+00C9 */
+    {  762, 5, 9, 0, -2, 6 }, /* U+00CA */
+    {  771, 5, 9, 0, -2, 6 }, /* U+00CB */
+    {  780, 5, 9, 0, -2, 6 }, /* U+00CC */
+    {  789, 5, 9, 0, -2, 6 }, /* U+00CD */
+    {  798, 5, 9, 0, -2, 6 }, /* U+00CE */
+    {  807, 5, 9, 0, -2, 6 }, /* U+00CF */
+    {  816, 5, 9, 0, -2, 6 }, /* U+00D1 */
+    {  825, 5, 9, 0, -2, 6 }, /* U+00D2 */
+    {  834, 5, 9, 0, -2, 6 }, /* U+00D3 */
+    {  843, 5, 9, 0, -2, 6 }, /* U+00D4 */
+    {  852, 5, 9, 0, -2, 6 }, /* U+00D5 */
+    {  861, 5, 9, 0, -2, 6 }, /* U+00D6 */
+    {  870, 5, 7, 0,  0, 6 }, /* U+00D7 */
+    {  877, 5, 9, 0, -2, 6 }, /* U+00D9 */
+    {  886, 5, 9, 0, -2, 6 }, /* U+00DA */
+    {  895, 5, 9, 0, -2, 6 }, /* U+00DB */
+    {  904, 5, 9, 0, -2, 6 }, /* U+00DC */
+    {  913, 5, 9, 0, -2, 6 }, /* U+00DD */
+    {  922, 5, 7, 0,  0, 6 }, /* U+00DF */
+    {  929, 5, 7, 0,  0, 6 }, /* U+00E0 */
+    {  936, 5, 7, 0,  0, 6 }, /* U+00E1 */
+    {  943, 5, 7, 0,  0, 6 }, /* U+00E2 */
+    {  950, 5, 7, 0,  0, 6 }, /* U+00E3 */
+    {  957, 5, 7, 0,  0, 6 }, /* U+00E4 */
+    {  964, 5, 9, 0,  0, 6 }, /* U+00E7 */
+    {  973, 5, 7, 0,  0, 6 }, /* U+00E8 */
+    {  980, 5, 7, 0,  0, 6 }, /* U+00E9 */
+    {  987, 5, 7, 0,  0, 6 }, /* U+00EA */
+    {  994, 5, 7, 0,  0, 6 }, /* U+00EB */
+    { 1001, 5, 7, 0,  0, 6 }, /* U+00EC */
+    { 1008, 5, 7, 0,  0, 6 }, /* U+00ED */
+    { 1015, 5, 7, 0,  0, 6 }, /* U+00EE */
+    { 1022, 5, 7, 0,  0, 6 }, /* U+00EF */
+    { 1029, 5, 7, 0,  0, 6 }, /* U+00F1 */
+    { 1036, 5, 7, 0,  0, 6 }, /* U+00F2 */
+    { 1043, 5, 7, 0,  0, 6 }, /* U+00F3 */
+    { 1050, 5, 7, 0,  0, 6 }, /* U+00F4 */
+    { 1057, 5, 7, 0,  0, 6 }, /* U+00F5 */
+    { 1064, 5, 7, 0,  0, 6 }, /* U+00F6 */
+    { 1071, 5, 7, 0,  0, 6 }, /* U+00F9 */
+    { 1078, 5, 7, 0,  0, 6 }, /* U+00FA */
+    { 1085, 5, 7, 0,  0, 6 }, /* U+00FB */
+    { 1092, 5, 7, 0,  0, 6 }, /* U+00FC */
+    { 1099, 5, 7, 0,  0, 6 }, /* U+00FD */
+    { 1106, 5, 7, 0,  0, 6 }, /* U+00FF */
+    { 1113, 5, 7, 0,  0, 6 }, /* U+20AC */
+};
+
+/*
+ * Codepoint ranges of the built-in font.
+ */
+static const epd_font_range_t font_5x7_ranges[] = {
+    { 0x0020, 0x007E,   0 },
+    { 0x00A1, 0x00A1,  95 },
+    { 0x00B0, 0x00B0,  96 },
+    { 0x00B5, 0x00B5,  97 },
+    { 0x00BF, 0x00C4,  98 },
+    { 0x00C7, 0x00CF, 104 },
+    { 0x00D1, 0x00D7, 113 },
+    { 0x00D9, 0x00DD, 120 },
+    { 0x00DF, 0x00E4, 125 },
+    { 0x00E7, 0x00EF, 131 },
+    { 0x00F1, 0x00F6, 140 },
+    { 0x00F9, 0x00FD, 146 },
+    { 0x00FF, 0x00FF, 151 },
+    { 0x20AC, 0x20AC, 152 },
+};
+
+const epd_font_t font_5x7 = {
+    .bitmap      = font_5x7_bitmap,
+    .glyphs      = font_5x7_glyphs,
+    .ranges      = font_5x7_ranges,
+    .range_count = sizeof(font_5x7_ranges) / sizeof(font_5x7_ranges[0]),
+    .line_height = 9,
+    .fallback    = '?',
 };
 
 /*----------------------------------------------------------------------------*/
 
-const uint8_t* font_get_glyph(char c) {
-    if (c < ' ' || c > 'z')
-        c = ' ';
+static const epd_font_glyph_t* font_find_glyph(const epd_font_t* font,
+                                               uint32_t codepoint) {
+    size_t low  = 0;
+    size_t high = font->range_count;
+
+    while (low < high) {
+        const size_t mid              = low + (high - low) / 2;
+        const epd_font_range_t* range = &font->ranges[mid];
+
+        if (codepoint < range->first)
+            high = mid;
+        else if (codepoint > range->last)
+            low = mid + 1;
+        else
+            return &font->glyphs[range->glyph_index +
+                                 (codepoint - range->first)];
+    }
+
+    return NULL;
+}
+
+const epd_font_glyph_t* font_get_glyph(const epd_font_t* font,
+                                       uint32_t codepoint) {
+    const epd_font_glyph_t* glyph = font_find_glyph(font, codepoint);
+    if (glyph == NULL)
+        glyph = font_find_glyph(font, font->fallback);
+
+    return glyph;
+}
+
+uint32_t font_utf8_next(const char** str) {
+    const uint8_t* s = (const uint8_t*)*str;
+
+    /*
+     * Get the number of continuation bytes, and the payload bits of the
+     * leading byte.
+     */
+    uint32_t codepoint;
+    int continuation;
+    uint32_t min_codepoint;
+    if (s[0] == '\0') {
+        return 0;
+    } else if (s[0] < 0x80) {
+        *str += 1;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        codepoint     = s[0] & 0x1F;
+        continuation  = 1;
+        min_codepoint = 0x80;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        codepoint     = s[0] & 0x0F;
+        continuation  = 2;
+        min_codepoint = 0x800;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        codepoint     = s[0] & 0x07;
+        continuation  = 3;
+        min_codepoint = 0x10000;
+    } else {
+        *str += 1;
+        return 0xFFFD;
+    }
+
+    for (int i = 1; i <= continuation; i++) {
+        /*
+         * On truncated sequences, only skip the bytes that have been read, so
+         * a terminating null byte is never skipped.
+         */
+        if ((s[i] & 0xC0) != 0x80) {
+            *str += i;
+            return 0xFFFD;
+        }
+
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
+    }
+
+    *str += continuation + 1;
+
+    /* Reject overlong encodings, surrogates and out-of-range values */
+    if (codepoint < min_codepoint || codepoint > 0x10FFFF ||
+        (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        return 0xFFFD;
 
-    return font[c - ' '];
+    return codepoint;
 }
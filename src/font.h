@@ -21,23 +21,95 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct epd_font_glyph epd_font_glyph_t;
+typedef struct epd_font_range epd_font_range_t;
+typedef struct epd_font epd_font_t;
+
+/*
+ * Information about a single glyph of a font.
+ *
+ * The bitmap of the glyph contains 'height' rows, starting at 'bitmap_offset'.
+ * Each row is padded to a whole number of bytes, with the leftmost pixel in the
+ * most significant bit, which is the same layout used by the framebuffer. This
+ * way, rows can be blitted directly without unpacking each pixel.
+ */
+struct epd_font_glyph {
+    /* Offset of the first row inside of the 'bitmap' array of the font */
+    uint16_t bitmap_offset;
+
+    /* Dimensions of the bitmap, in pixels */
+    uint8_t width, height;
+
+    /*
+     * Position of the top-left corner of the bitmap, relative to the position
+     * of the pen. The pen is placed at the top-left corner of the line, so the
+     * vertical offset can be negative for glyphs that are taller than the line
+     * (e.g. accented capital letters).
+     */
+    int8_t x_offset, y_offset;
+
+    /* Horizontal distance between this glyph and the next one, in pixels */
+    uint8_t advance;
+};
+
+/*
+ * Range of consecutive codepoints with glyphs in a font. The glyph of
+ * codepoint 'first' is at index 'glyph_index' inside of the 'glyphs' array of
+ * the font, and the rest follow it in order.
+ */
+struct epd_font_range {
+    uint32_t first, last;
+    uint16_t glyph_index;
+};
+
 /*
- * Width of the internal bitmap font.
+ * Bitmap font with an arbitrary number of Unicode codepoints. The ranges must
+ * be sorted and must not overlap, since they are binary searched.
  */
-#define FONT_WIDTH 5
+struct epd_font {
+    const uint8_t* bitmap;
+    const epd_font_glyph_t* glyphs;
+    const epd_font_range_t* ranges;
+    uint16_t range_count;
+
+    /* Vertical distance between two lines of text, in pixels */
+    uint8_t line_height;
+
+    /* Codepoint used for characters that are not in the font */
+    uint32_t fallback;
+};
+
+/*----------------------------------------------------------------------------*/
 
 /*
- * Height of the internal bitmap font.
+ * Built-in font, with 5x7 glyphs for printable ASCII, Latin-1 letters and some
+ * common symbols. Each glyph advances 6 pixels.
  */
-#define FONT_HEIGHT 7
+extern const epd_font_t font_5x7;
 
 /*----------------------------------------------------------------------------*/
 
 /*
- * Get the glyph for the internal 5x7 font. The glyph is a pointer to an array
- * of FONT_WIDTH bytes, where each byte contains FONT_HEIGHT bits of bitmap
- * data about the specified character.
+ * Get the glyph of the specified codepoint in a font. If the font doesn't
+ * contain it, the glyph of its fallback codepoint is returned instead. Returns
+ * NULL if neither of them are in the font.
  */
-const uint8_t* font_get_glyph(char c);
+const epd_font_glyph_t* font_get_glyph(const epd_font_t* font,
+                                       uint32_t codepoint);
+
+/*
+ * Decode the next UTF-8 character of the specified string, and move the string
+ * pointer after it. Returns zero at the end of the string (without moving the
+ * pointer), and U+FFFD for invalid sequences.
+ */
+uint32_t font_utf8_next(const char** str);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* FONT_H_ */
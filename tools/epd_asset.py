@@ -0,0 +1,450 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026 8dcc
+#
+# This file is part of rp2350-epaper.
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Convert a PNG, PBM or PGM image into an 'epd_image_t' for the E-Paper Display
+library (see 'src/epaper_display_image.h').
+
+The image is converted to grayscale (transparent pixels are white), rotated,
+reduced to 1bpp with the selected method and packed in the framebuffer layout,
+so drawing it doesn't need any conversion at runtime. Example:
+
+    tools/epd_asset.py logo.png --name asset_logo --rotate 90 \\
+        --dither atkinson --compress --output logo.c --header logo.h
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+BAYER_MATRIX = [
+    [0, 32, 8, 40, 2, 34, 10, 42],
+    [48, 16, 56, 24, 50, 18, 58, 26],
+    [12, 44, 4, 36, 14, 46, 6, 38],
+    [60, 28, 52, 20, 62, 30, 54, 22],
+    [3, 35, 11, 43, 1, 33, 9, 41],
+    [51, 19, 59, 27, 49, 17, 57, 25],
+    [15, 47, 7, 39, 13, 45, 5, 37],
+    [63, 31, 55, 23, 61, 29, 53, 21],
+]
+
+# Must match EPD_IMAGE_MAX_WIDTH in 'src/epaper_display_image.h'
+MAX_COMPRESSED_WIDTH = 512
+
+# Size of the largest supported panel, in its native orientation
+PANEL_WIDTH = 128
+PANEL_HEIGHT = 296
+
+
+def fail(message):
+    sys.exit("error: %s" % message)
+
+
+def warn(message):
+    print("warning: %s" % message, file=sys.stderr)
+
+
+# ------------------------------------------------------------------------------
+# Image loading. All loaders return (width, height, rows), where each row is a
+# list of gray levels in the [0..255] range.
+
+
+def to_gray(r, g, b):
+    return (r * 299 + g * 587 + b * 114) // 1000
+
+
+def blend_white(gray, alpha):
+    return (gray * alpha + 255 * (255 - alpha)) // 255
+
+
+def unpack_samples(data, depth, count):
+    """Unpack 'count' samples of 'depth' bits from a PNG scanline."""
+    if depth == 8:
+        return list(data[:count])
+    if depth == 16:
+        return [data[2 * i] for i in range(count)]
+
+    samples = []
+    per_byte = 8 // depth
+    mask = (1 << depth) - 1
+    for i in range(count):
+        byte = data[i // per_byte]
+        shift = 8 - depth * (i % per_byte + 1)
+        samples.append((byte >> shift) & mask)
+    return samples
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def load_png(data):
+    pos = 8
+    header = None
+    palette = []
+    palette_alpha = []
+    compressed = bytearray()
+
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            palette_alpha = list(body)
+        elif kind == b"IDAT":
+            compressed += body
+        elif kind == b"IEND":
+            break
+
+    if header is None:
+        fail("PNG file without IHDR chunk")
+
+    width, height, depth, color_type, _, _, interlace = header
+    if interlace != 0:
+        fail("interlaced PNG files are not supported")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color_type)
+    if channels is None:
+        fail("unsupported PNG color type %d" % color_type)
+
+    raw = zlib.decompress(bytes(compressed))
+    bpp = max(1, channels * depth // 8)
+    stride = (width * channels * depth + 7) // 8
+    max_value = (1 << depth) - 1
+
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        line = bytearray(raw[start + 1:start + 1 + stride])
+
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + paeth(a, b, c)) & 0xFF
+        prev = line
+
+        samples = unpack_samples(line, depth, width * channels)
+        if depth != 16:
+            samples = [s * 255 // max_value for s in samples] \
+                if color_type != 3 else samples
+
+        row = []
+        for x in range(width):
+            px = samples[x * channels:(x + 1) * channels]
+            if color_type == 0:
+                row.append(px[0])
+            elif color_type == 2:
+                row.append(to_gray(*px))
+            elif color_type == 3:
+                r, g, b = palette[px[0]]
+                alpha = palette_alpha[px[0]] \
+                    if px[0] < len(palette_alpha) else 255
+                row.append(blend_white(to_gray(r, g, b), alpha))
+            elif color_type == 4:
+                row.append(blend_white(px[0], px[1]))
+            else:
+                row.append(blend_white(to_gray(*px[:3]), px[3]))
+        rows.append(row)
+
+    return width, height, rows
+
+
+def load_netpbm(data):
+    """Load a PBM (P1, P4) or PGM (P2, P5) image."""
+    magic = data[:2]
+    pos = 2
+
+    def next_token():
+        nonlocal pos
+        while True:
+            while pos < len(data) and data[pos:pos + 1].isspace():
+                pos += 1
+            if data[pos:pos + 1] == b"#":
+                while pos < len(data) and data[pos:pos + 1] != b"\n":
+                    pos += 1
+                continue
+            break
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace():
+            pos += 1
+        return int(data[start:pos])
+
+    width = next_token()
+    height = next_token()
+    max_value = 1 if magic in (b"P1", b"P4") else next_token()
+
+    if magic == b"P1":
+        bits = []
+        while len(bits) < width * height:
+            while data[pos:pos + 1] not in (b"0", b"1"):
+                pos += 1
+            bits.append(data[pos] == ord("1"))
+            pos += 1
+        return width, height, [
+            [0 if bits[y * width + x] else 255 for x in range(width)]
+            for y in range(height)]
+
+    if magic == b"P2":
+        values = [next_token() for _ in range(width * height)]
+        return width, height, [
+            [values[y * width + x] * 255 // max_value for x in range(width)]
+            for y in range(height)]
+
+    pos += 1
+    if magic == b"P4":
+        stride = (width + 7) // 8
+        rows = []
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            rows.append([0 if (line[x // 8] >> (7 - x % 8)) & 1 else 255
+                         for x in range(width)])
+        return width, height, rows
+
+    if magic == b"P5":
+        size = 2 if max_value > 255 else 1
+        rows = []
+        for y in range(height):
+            row = []
+            for x in range(width):
+                i = pos + (y * width + x) * size
+                value = data[i] if size == 1 else (data[i] << 8) | data[i + 1]
+                row.append(value * 255 // max_value)
+            rows.append(row)
+        return width, height, rows
+
+    fail("unsupported Netpbm format %r" % magic)
+
+
+def load_image(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(b"\x89PNG\r\n\x1a\n"):
+        return load_png(data)
+    if data[:2] in (b"P1", b"P2", b"P4", b"P5"):
+        return load_netpbm(data)
+    fail("'%s' is not a PNG, PBM or PGM file" % path)
+
+
+# ------------------------------------------------------------------------------
+# Conversion
+
+
+def rotate(width, height, rows, degrees):
+    """Rotate the image clockwise by a multiple of 90 degrees."""
+    if degrees == 90:
+        return height, width, [[rows[height - 1 - x][y] for x in range(height)]
+                               for y in range(width)]
+    if degrees == 180:
+        return width, height, [list(reversed(row)) for row in reversed(rows)]
+    if degrees == 270:
+        return height, width, [[rows[x][width - 1 - y] for x in range(height)]
+                               for y in range(width)]
+    return width, height, rows
+
+
+def dither(width, height, rows, method, threshold):
+    """Return the rows as lists of booleans, where True is white."""
+    if method == "threshold":
+        return [[value >= threshold for value in row] for row in rows]
+
+    if method == "bayer":
+        return [[value >= BAYER_MATRIX[y & 7][x & 7] * 4 + 2
+                 for x, value in enumerate(row)]
+                for y, row in enumerate(rows)]
+
+    if method == "floyd-steinberg":
+        weights = [(1, 0, 7), (-1, 1, 3), (0, 1, 5), (1, 1, 1)]
+        divisor = 16
+    else:
+        weights = [(1, 0, 1), (2, 0, 1), (-1, 1, 1), (0, 1, 1), (1, 1, 1),
+                   (0, 2, 1)]
+        divisor = 8
+
+    error = [[0.0] * width for _ in range(height)]
+    result = []
+    for y in range(height):
+        out = []
+        for x in range(width):
+            value = rows[y][x] + error[y][x]
+            white = value >= threshold
+            diff = value - (255 if white else 0)
+            for dx, dy, weight in weights:
+                if 0 <= x + dx < width and y + dy < height:
+                    error[y + dy][x + dx] += diff * weight / divisor
+            out.append(white)
+        result.append(out)
+    return result
+
+
+def pack(width, bits):
+    """Pack boolean rows MSB-first, with set bits for white pixels."""
+    data = bytearray()
+    for row in bits:
+        for i in range(0, width, 8):
+            byte = 0
+            for j, white in enumerate(row[i:i + 8]):
+                if white:
+                    byte |= 0x80 >> j
+            data.append(byte)
+    return bytes(data)
+
+
+def packbits(data):
+    """Compress with PackBits, as decoded by 'src/epaper_display_image.c'."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+
+        if run >= 2:
+            out += bytes([(257 - run) & 0xFF, data[i]])
+            i += run
+            continue
+
+        # Literal run, until the next repetition of 3 or more bytes
+        start = i
+        while i < len(data) and i - start < 128:
+            if (i + 2 < len(data) and data[i] == data[i + 1] == data[i + 2]):
+                break
+            i += 1
+        out.append(i - start - 1)
+        out += data[start:i]
+    return bytes(out)
+
+
+# ------------------------------------------------------------------------------
+# Output
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 12):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 12])
+                     + ",")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("image", help="input PNG, PBM or PGM image")
+    parser.add_argument("--name", required=True,
+                        help="name of the exported 'epd_image_t' variable")
+    parser.add_argument("--rotate", type=int, default=0,
+                        choices=[0, 90, 180, 270],
+                        help="clockwise rotation, in degrees")
+    parser.add_argument("--dither", default="threshold",
+                        choices=["threshold", "bayer", "floyd-steinberg",
+                                 "atkinson"],
+                        help="method for reducing the image to 1bpp")
+    parser.add_argument("--threshold", type=int, default=128,
+                        help="gray level from which pixels are white")
+    parser.add_argument("--invert", action="store_true",
+                        help="invert the image before converting it")
+    parser.add_argument("--compress", action="store_true",
+                        help="compress with PackBits, if it's smaller and "
+                        "at most %d pixels wide" % MAX_COMPRESSED_WIDTH)
+    parser.add_argument("--output", help="output C file, defaults to stdout")
+    parser.add_argument("--header", help="also write a C header")
+    args = parser.parse_args()
+
+    width, height, rows = load_image(args.image)
+    if args.invert:
+        rows = [[255 - value for value in row] for row in rows]
+    width, height, rows = rotate(width, height, rows, args.rotate)
+    if width > 0xFFFF or height > 0xFFFF:
+        fail("image is too large")
+    if not ((width <= PANEL_WIDTH and height <= PANEL_HEIGHT) or
+            (width <= PANEL_HEIGHT and height <= PANEL_WIDTH)):
+        warn("%s is %dx%d, larger than the %dx%d panel" %
+             (args.image, width, height, PANEL_WIDTH, PANEL_HEIGHT))
+
+    data = pack(width, dither(width, height, rows, args.dither,
+                              args.threshold))
+    compression = "EPD_IMAGE_RAW"
+    if args.compress and width > MAX_COMPRESSED_WIDTH:
+        warn("%s is wider than %d pixels, so it can't be decoded compressed; "
+             "storing it uncompressed" % (args.image, MAX_COMPRESSED_WIDTH))
+    elif args.compress:
+        compressed = packbits(data)
+        if len(compressed) < len(data):
+            data = compressed
+            compression = "EPD_IMAGE_PACKBITS"
+
+    out = []
+    out.append("/* Generated by tools/epd_asset.py from '%s' */" % args.image)
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append('#include "epaper_display_image.h"')
+    out.append("")
+    out.append("static const uint8_t %s_data[] = {" % args.name)
+    out += c_array(data)
+    out.append("};")
+    out.append("")
+    out.append("const epd_image_t %s = {" % args.name)
+    out.append("    .width       = %d," % width)
+    out.append("    .height      = %d," % height)
+    out.append("    .compression = %s," % compression)
+    out.append("    .data        = %s_data," % args.name)
+    out.append("    .size        = sizeof(%s_data)," % args.name)
+    out.append("};")
+
+    source = "\n".join(out) + "\n"
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(source)
+    else:
+        sys.stdout.write(source)
+
+    if args.header:
+        guard = args.name.upper() + "_H_"
+        with open(args.header, "w") as f:
+            f.write("/* Generated by tools/epd_asset.py from '%s' */\n\n"
+                    "#ifndef %s\n#define %s 1\n\n"
+                    '#include "epaper_display_image.h"\n\n'
+                    "extern const epd_image_t %s;\n\n"
+                    "#endif /* %s */\n"
+                    % (args.image, guard, guard, args.name, guard))
+
+
+if __name__ == "__main__":
+    main()
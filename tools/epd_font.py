@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026 8dcc
+#
+# This file is part of rp2350-epaper.
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Convert a BDF bitmap font into the 'epd_font_t' format used by the E-Paper
+Display library (see 'src/font.h').
+
+Only the requested codepoint ranges are exported, and the bitmap of each glyph
+is cropped to its bounding box, so large fonts stay small in flash. Example:
+
+    tools/epd_font.py ter-u16b.bdf --name font_terminus_16 \\
+        --ranges 0x20-0x7E,0xA0-0xFF,0x20AC > src/font_terminus_16.c
+"""
+
+import argparse
+import sys
+
+
+def parse_ranges(text):
+    codepoints = set()
+    for part in text.split(","):
+        if "-" in part:
+            first, last = part.split("-")
+            codepoints.update(range(int(first, 0), int(last, 0) + 1))
+        else:
+            codepoints.add(int(part, 0))
+    return codepoints
+
+
+def parse_bdf(path):
+    """
+    Return the font line height and a dictionary of glyphs indexed by codepoint.
+    Each glyph is a tuple of (width, height, x_offset, y_offset, advance, rows),
+    where the offsets are relative to the top-left corner of the line and each
+    row is an integer with the leftmost pixel in the most significant bit.
+    """
+    ascent = None
+    descent = 0
+    glyphs = {}
+    glyph = None
+    bitmap = None
+
+    with open(path, encoding="latin-1") as f:
+        for line in f:
+            words = line.split()
+            if not words:
+                continue
+
+            keyword = words[0]
+            if bitmap is not None:
+                if keyword == "ENDCHAR":
+                    glyph["rows"] = bitmap
+                    bitmap = None
+                    if glyph["encoding"] >= 0:
+                        glyphs[glyph["encoding"]] = glyph
+                    glyph = None
+                else:
+                    bitmap.append(int(keyword, 16))
+            elif keyword == "FONT_ASCENT":
+                ascent = int(words[1])
+            elif keyword == "FONT_DESCENT":
+                descent = int(words[1])
+            elif keyword == "STARTCHAR":
+                glyph = {"encoding": -1}
+            elif glyph is None:
+                continue
+            elif keyword == "ENCODING":
+                glyph["encoding"] = int(words[1])
+            elif keyword == "DWIDTH":
+                glyph["advance"] = int(words[1])
+            elif keyword == "BBX":
+                glyph["bbx"] = [int(word) for word in words[1:5]]
+            elif keyword == "BITMAP":
+                bitmap = []
+
+    if ascent is None:
+        sys.exit("error: the font doesn't define FONT_ASCENT")
+
+    result = {}
+    for codepoint, glyph in glyphs.items():
+        width, height, x_off, y_off = glyph["bbx"]
+        rows = list(glyph["rows"])
+
+        # Crop empty rows at the top and bottom of the bounding box
+        while rows and rows[0] == 0:
+            rows.pop(0)
+            height -= 1
+        while rows and rows[-1] == 0:
+            rows.pop()
+            y_off += 1
+            height -= 1
+
+        top = ascent - (y_off + height)
+        result[codepoint] = (width if rows else 0, height, x_off, top,
+                             glyph.get("advance", width), rows)
+
+    return ascent + descent, result
+
+
+def c_name(codepoint):
+    if 0x20 < codepoint < 0x7F and chr(codepoint) not in "*/\\":
+        return chr(codepoint)
+    return "U+%04X" % codepoint
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("bdf", help="input BDF font")
+    parser.add_argument("--name", required=True,
+                        help="name of the exported 'epd_font_t' variable")
+    parser.add_argument("--ranges", default="0x20-0x7E",
+                        help="comma-separated codepoints or ranges to export")
+    parser.add_argument("--line-height", type=int,
+                        help="line height, defaults to ascent plus descent")
+    parser.add_argument("--fallback", default="?",
+                        help="character drawn for missing codepoints")
+    args = parser.parse_args()
+
+    font_height, glyphs = parse_bdf(args.bdf)
+    wanted = parse_ranges(args.ranges)
+    codepoints = sorted(cp for cp in glyphs if cp in wanted)
+    if not codepoints:
+        sys.exit("error: none of the requested codepoints are in the font")
+
+    line_height = args.line_height
+    if line_height is None:
+        line_height = font_height
+
+    # Group consecutive codepoints into ranges
+    ranges = []
+    for index, codepoint in enumerate(codepoints):
+        if ranges and ranges[-1][1] == codepoint - 1:
+            ranges[-1][1] = codepoint
+        else:
+            ranges.append([codepoint, codepoint, index])
+
+    out = []
+    out.append("/* Generated by tools/epd_font.py from '%s' */" % args.bdf)
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append('#include "font.h"')
+    out.append("")
+    out.append("static const uint8_t %s_bitmap[] = {" % args.name)
+
+    offsets = {}
+    offset = 0
+    for codepoint in codepoints:
+        width, height, _, _, _, rows = glyphs[codepoint]
+        row_bytes = (width + 7) // 8
+        data = []
+        for row in rows:
+            data += [(row >> (8 * (row_bytes - 1 - i))) & 0xFF
+                     for i in range(row_bytes)]
+        offsets[codepoint] = offset
+        offset += len(data)
+        if data:
+            out.append("    %s, /* %s */" % (
+                ", ".join("0x%02X" % byte for byte in data),
+                c_name(codepoint)))
+
+    if offset > 0xFFFF:
+        sys.exit("error: bitmap data doesn't fit in 16-bit offsets")
+
+    # Empty initializers are not valid C, so fonts without any pixels (like
+    # one with only a space) get a byte that no glyph uses
+    if offset == 0:
+        out.append("    0x00, /* Unused */")
+
+    out.append("};")
+    out.append("")
+    out.append("static const epd_font_glyph_t %s_glyphs[] = {" % args.name)
+    for codepoint in codepoints:
+        width, height, x_off, top, advance, _ = glyphs[codepoint]
+        out.append("    { %d, %d, %d, %d, %d, %d }, /* %s */" % (
+            offsets[codepoint], width, height, x_off, top, advance,
+            c_name(codepoint)))
+    out.append("};")
+    out.append("")
+    out.append("static const epd_font_range_t %s_ranges[] = {" % args.name)
+    for first, last, index in ranges:
+        out.append("    { 0x%04X, 0x%04X, %d }," % (first, last, index))
+    out.append("};")
+    out.append("")
+    out.append("const epd_font_t %s = {" % args.name)
+    out.append("    .bitmap      = %s_bitmap," % args.name)
+    out.append("    .glyphs      = %s_glyphs," % args.name)
+    out.append("    .ranges      = %s_ranges," % args.name)
+    out.append("    .range_count = %d," % len(ranges))
+    out.append("    .line_height = %d," % line_height)
+    out.append("    .fallback    = 0x%04X," % ord(args.fallback))
+    out.append("};")
+
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,370 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026 8dcc
+#
+# This file is part of rp2350-epaper.
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Send images to the E-Paper Display over a serial port (usually USB CDC), using
+the protocol decoded by 'src/epaper_display_stream.c'.
+
+The 'frame' command sends a whole image, and the 'diff' command only sends the
+tiles that differ between two images. Both are followed by a flush. Images are
+converted like in 'tools/epd_asset.py', and must have the size of the display
+after being rotated. Examples:
+
+    tools/epd_stream.py --port /dev/ttyACM0 frame screen.png --rotate 90
+    tools/epd_stream.py --port /dev/ttyACM0 diff old.png new.png --tile 32
+
+Without '--port', the packets are sent through a pseudo-terminal to a device
+stand-in, which decodes them like the firmware and checks the result. This is
+useful for testing the tool without a board.
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import pty
+import select
+import struct
+import sys
+import threading
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import epd_asset  # noqa: E402
+
+SYNC = b"\xEB\x50"
+
+ACK = 0x06
+NAK = 0x15
+
+FLAG_PACKBITS = 0x01
+
+PACKET_FRAME = 0x01
+PACKET_TILE = 0x02
+PACKET_FLUSH = 0x03
+
+# Must match EPD_STREAM_MAX_WIDTH
+MAX_TILE_WIDTH = 512
+
+# Maximum payload size, limited by the 16-bit size field
+MAX_PAYLOAD = 0xFFFF
+
+RETRIES = 3
+
+
+def fail(message):
+    sys.exit("error: %s" % message)
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as computed by the decoder."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+# ------------------------------------------------------------------------------
+# Packets
+
+
+def packet(kind, payload=b"", compress=True):
+    """Build a packet, compressing its rows if it makes them smaller."""
+    flags = 0
+    if compress and kind in (PACKET_FRAME, PACKET_TILE):
+        header = payload[:8] if kind == PACKET_TILE else b""
+        rows = epd_asset.packbits(payload[len(header):])
+        if len(header) + len(rows) < len(payload):
+            payload = header + rows
+            flags |= FLAG_PACKBITS
+
+    if len(payload) > MAX_PAYLOAD:
+        fail("packet payload is too large (%d bytes)" % len(payload))
+
+    body = struct.pack("<BBH", kind, flags, len(payload)) + payload
+    return SYNC + body + struct.pack("<H", crc16(body))
+
+
+def frame_packets(data, compress):
+    return [packet(PACKET_FRAME, data, compress)]
+
+
+def tile_packets(width, height, old, new, tile, compress):
+    """Build a packet for each tile that differs between two images."""
+    stride = width // 8
+    packets = []
+    for y in range(0, height, tile):
+        h = min(tile, height - y)
+        for x in range(0, width, tile):
+            w = min(tile, width - x)
+            rows = b"".join(new[(y + i) * stride + x // 8:
+                                (y + i) * stride + (x + w + 7) // 8]
+                            for i in range(h))
+            old_rows = b"".join(old[(y + i) * stride + x // 8:
+                                    (y + i) * stride + (x + w + 7) // 8]
+                                for i in range(h))
+            if rows == old_rows:
+                continue
+            header = struct.pack("<HHHH", x, y, w, h)
+            packets.append(packet(PACKET_TILE, header + rows, compress))
+    return packets
+
+
+# ------------------------------------------------------------------------------
+# Transport
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    return fd
+
+
+def wait_reply(fd, timeout):
+    """Wait for an ACK or NAK, ignoring any other output of the device."""
+    while True:
+        ready, _, _ = select.select([fd], [], [], timeout)
+        if not ready:
+            return None
+        for byte in os.read(fd, 256):
+            if byte in (ACK, NAK):
+                return byte
+
+
+def send(fd, packets, timeout):
+    for i, data in enumerate(packets):
+        for attempt in range(RETRIES):
+            os.write(fd, data)
+            reply = wait_reply(fd, timeout)
+            if reply == ACK:
+                break
+            if reply is None:
+                fail("no reply to packet %d" % i)
+        else:
+            fail("packet %d was rejected %d times" % (i, RETRIES))
+
+
+# ------------------------------------------------------------------------------
+# Device stand-in, for testing without a board
+
+
+class Device:
+    """Decoder with the same behavior as 'src/epaper_display_stream.c'."""
+
+    def __init__(self, width, height):
+        self.width = width
+        self.height = height
+        self.framebuffer = bytearray(b"\xFF" * (width // 8 * height))
+        self.flushed = None
+        self.buffer = bytearray()
+
+    def unpack(self, data):
+        out = bytearray()
+        i = 0
+        while i < len(data):
+            header = data[i] - 256 if data[i] >= 128 else data[i]
+            i += 1
+            if header == -128:
+                continue
+            if header < 0:
+                out += data[i:i + 1] * (1 - header)
+                i += 1
+            else:
+                out += data[i:i + header + 1]
+                i += header + 1
+        return bytes(out)
+
+    def draw(self, x, y, w, h, rows):
+        stride = (w + 7) // 8
+        if w > MAX_TILE_WIDTH or len(rows) != stride * h:
+            return False
+        for row in range(h):
+            for col in range(w):
+                if not 0 <= x + col < self.width or \
+                   not 0 <= y + row < self.height:
+                    continue
+                white = rows[row * stride + col // 8] & (0x80 >> (col % 8))
+                pos = (y + row) * (self.width // 8) + (x + col) // 8
+                bit = 0x80 >> ((x + col) % 8)
+                if white:
+                    self.framebuffer[pos] |= bit
+                else:
+                    self.framebuffer[pos] &= ~bit
+        return True
+
+    def process(self, kind, flags, payload):
+        if kind == PACKET_FLUSH:
+            self.flushed = bytes(self.framebuffer)
+            return not payload
+        if kind == PACKET_FRAME:
+            x, y, w, h = 0, 0, self.width, self.height
+        elif kind == PACKET_TILE and len(payload) >= 8:
+            x, y, w, h = struct.unpack("<HHHH", payload[:8])
+            payload = payload[8:]
+        else:
+            return False
+        if flags & FLAG_PACKBITS:
+            payload = self.unpack(payload)
+        return self.draw(x, y, w, h, payload)
+
+    def feed(self, data):
+        """Process the received bytes, returning the replies."""
+        self.buffer += data
+        replies = bytearray()
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < 6:
+                break
+            kind, flags, size = struct.unpack("<BBH", self.buffer[2:6])
+            if len(self.buffer) < 8 + size:
+                break
+            body = bytes(self.buffer[2:6 + size])
+            (crc,) = struct.unpack("<H", self.buffer[6 + size:8 + size])
+            del self.buffer[:8 + size]
+            ok = crc == crc16(body) and self.process(kind, flags, body[4:])
+            replies.append(ACK if ok else NAK)
+        return bytes(replies)
+
+
+def run_device(fd, device, stop):
+    while not stop.is_set():
+        ready, _, _ = select.select([fd], [], [], 0.05)
+        if ready:
+            replies = device.feed(os.read(fd, 4096))
+            if replies:
+                os.write(fd, replies)
+
+
+# ------------------------------------------------------------------------------
+
+
+def load(path, args):
+    width, height, rows = epd_asset.load_image(path)
+    if args.invert:
+        rows = [[255 - value for value in row] for row in rows]
+    width, height, rows = epd_asset.rotate(width, height, rows, args.rotate)
+    if (width, height) != (args.width, args.height):
+        fail("'%s' is %dx%d after rotating, but the display is %dx%d" %
+             (path, width, height, args.width, args.height))
+    return epd_asset.pack(width, epd_asset.dither(width, height, rows,
+                                                  args.dither, args.threshold))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("--port",
+                        help="serial port of the device, or a loopback test "
+                             "if omitted")
+    parser.add_argument("--width", type=int, default=128,
+                        help="width of the display, in pixels")
+    parser.add_argument("--height", type=int, default=296,
+                        help="height of the display, in pixels")
+    parser.add_argument("--raw", action="store_true",
+                        help="don't compress the packets")
+    parser.add_argument("--timeout", type=float, default=5.0,
+                        help="seconds to wait for each reply")
+
+    # Conversion options, accepted after each command
+    convert = argparse.ArgumentParser(add_help=False)
+    convert.add_argument("--rotate", type=int, default=0,
+                         choices=[0, 90, 180, 270],
+                         help="clockwise rotation, in degrees")
+    convert.add_argument("--dither", default="threshold",
+                         choices=["threshold", "bayer", "floyd-steinberg",
+                                  "atkinson"],
+                         help="method for reducing the images to 1bpp")
+    convert.add_argument("--threshold", type=int, default=128,
+                         help="gray level from which pixels are white")
+    convert.add_argument("--invert", action="store_true",
+                         help="invert the images before converting them")
+
+    commands = parser.add_subparsers(dest="command", required=True)
+    frame = commands.add_parser("frame", parents=[convert],
+                                help="send a whole image")
+    frame.add_argument("image", help="input PNG, PBM or PGM image")
+    diff = commands.add_parser("diff", parents=[convert],
+                               help="send the tiles that changed between two "
+                                    "images")
+    diff.add_argument("old", help="image currently on the display")
+    diff.add_argument("new", help="image to display")
+    diff.add_argument("--tile", type=int, default=32,
+                      help="tile size in pixels, multiple of 8")
+    args = parser.parse_args()
+
+    if args.width % 8 != 0:
+        fail("the display width must be a multiple of 8")
+
+    compress = not args.raw
+    if args.command == "frame":
+        old = None
+        new = load(args.image, args)
+        packets = frame_packets(new, compress)
+    else:
+        if args.tile <= 0 or args.tile % 8 != 0 or args.tile > MAX_TILE_WIDTH:
+            fail("the tile size must be a multiple of 8, up to %d" %
+                 MAX_TILE_WIDTH)
+        old = load(args.old, args)
+        new = load(args.new, args)
+        packets = tile_packets(args.width, args.height, old, new, args.tile,
+                               compress)
+    packets.append(packet(PACKET_FLUSH))
+
+    if args.port:
+        fd = open_port(args.port)
+        try:
+            send(fd, packets, args.timeout)
+        finally:
+            os.close(fd)
+        print("sent %d packets, %d bytes" %
+              (len(packets), sum(len(p) for p in packets)))
+        return
+
+    # Loopback: the device starts with the old image, if any
+    master, slave = pty.openpty()
+    device = Device(args.width, args.height)
+    if old is not None:
+        device.framebuffer[:] = old
+    stop = threading.Event()
+    thread = threading.Thread(target=run_device, args=(master, device, stop))
+    thread.start()
+    try:
+        fd = open_port(os.ttyname(slave))
+        try:
+            send(fd, packets, args.timeout)
+        finally:
+            os.close(fd)
+    finally:
+        stop.set()
+        thread.join()
+        os.close(master)
+        os.close(slave)
+
+    if device.flushed != new:
+        fail("loopback: the device framebuffer doesn't match the image")
+    print("loopback: sent %d packets, %d bytes, framebuffer matches" %
+          (len(packets), sum(len(p) for p in packets)))
+
+
+if __name__ == "__main__":
+    main()
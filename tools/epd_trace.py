@@ -0,0 +1,334 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026 8dcc
+#
+# This file is part of rp2350-epaper.
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or any later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program. If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Decode an SPI trace of the E-Paper Display, exported by 'epd_trace_dump' or
+'epd_trace_export' (see 'src/epaper_display_trace.h').
+
+The trace is read from a file, such as a capture of the serial output, or
+directly from a serial port. Any output around the trace is skipped. The
+timeline shows each transaction with the idle time before it, and the summary
+shows where the time went, along with commands that were sent again with the
+same data before a refresh, which had no effect. Examples:
+
+    tools/epd_trace.py capture.bin
+    tools/epd_trace.py --port /dev/ttyACM0 --summary
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import tty
+
+MAGIC = b"EPDT"
+VERSION = 1
+
+HEADER = struct.Struct("<4sBBHI")
+RECORD = struct.Struct("<IIHBB")
+
+TYPE_COMMAND = 0
+TYPE_DATA = 1
+TYPE_BUSY = 2
+
+# Commands of 'src/epaper_display_2in9.c'
+COMMANDS = {
+    0x01: "DRIVER_OUTPUT_CONTROL",
+    0x0C: "BOOSTER_SOFT_START_CONTROL",
+    0x10: "DEEP_SLEEP_MODE",
+    0x11: "DATA_ENTRY_MODE_SETTING",
+    0x12: "SW_RESET",
+    0x18: "TEMPERATURE_SENSOR_CONTROL",
+    0x20: "MASTER_ACTIVATION",
+    0x21: "DISPLAY_UPDATE_CONTROL_1",
+    0x22: "DISPLAY_UPDATE_CONTROL_2",
+    0x24: "WRITE_RAM",
+    0x26: "WRITE_RAM_PREVIOUS",
+    0x2C: "WRITE_VCOM_REGISTER",
+    0x32: "WRITE_LUT_REGISTER",
+    0x3A: "SET_DUMMY_LINE_PERIOD",
+    0x3B: "SET_GATE_TIME",
+    0x3C: "BORDER_WAVEFORM_CONTROL",
+    0x44: "SET_RAM_X_ADDRESS_START_END",
+    0x45: "SET_RAM_Y_ADDRESS_START_END",
+    0x4E: "SET_RAM_X_ADDRESS_COUNTER",
+    0x4F: "SET_RAM_Y_ADDRESS_COUNTER",
+}
+
+# Commands after which the settings of the controller can change, so sending
+# the same settings again is not redundant.
+RESET_COMMANDS = (0x10, 0x12, 0x20)
+
+# Commands whose data is written to the RAM, so repeating them is expected
+RAM_COMMANDS = (0x24, 0x26, 0x32)
+
+
+def fail(message):
+    sys.exit("error: %s" % message)
+
+
+def command_name(cmd):
+    return COMMANDS.get(cmd, "0x%02X" % cmd)
+
+
+class Record:
+    def __init__(self, start, duration, length, kind, data):
+        self.start = start
+        self.duration = duration
+        self.length = length
+        self.kind = kind
+        self.data = data
+
+
+# ------------------------------------------------------------------------------
+# Decoding
+
+
+def find_trace(data):
+    """Return the offset of the first trace header in 'data'."""
+    offset = data.find(MAGIC)
+    while offset >= 0:
+        if offset + HEADER.size <= len(data) and \
+           data[offset + len(MAGIC)] == VERSION:
+            return offset
+        offset = data.find(MAGIC, offset + 1)
+    return -1
+
+
+def trace_size(data, offset):
+    """Return the size of the trace at 'offset', or None if incomplete."""
+    if offset + HEADER.size > len(data):
+        return None
+    _, _, _, count, _ = HEADER.unpack_from(data, offset)
+    pos = offset + HEADER.size
+    for _ in range(count):
+        if pos + RECORD.size > len(data):
+            return None
+        stored = data[pos + RECORD.size - 1]
+        pos += RECORD.size + stored
+    return pos - offset if pos <= len(data) else None
+
+
+def decode(data):
+    """Decode the trace in 'data', returning (records, lost)."""
+    offset = find_trace(data)
+    if offset < 0:
+        fail("no trace found")
+    if trace_size(data, offset) is None:
+        fail("the trace is truncated")
+
+    _, _, _, count, lost = HEADER.unpack_from(data, offset)
+    pos = offset + HEADER.size
+    records = []
+    for _ in range(count):
+        start, duration, length, kind, stored = RECORD.unpack_from(data, pos)
+        pos += RECORD.size
+        records.append(Record(start, duration, length, kind,
+                              bytes(data[pos:pos + stored])))
+        pos += stored
+    return records, lost
+
+
+def read_port(path, timeout):
+    """Read from a serial port until a whole trace is received."""
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    tty.setraw(fd)
+    data = bytearray()
+    try:
+        while True:
+            ready, _, _ = select.select([fd], [], [], timeout)
+            if not ready:
+                fail("no complete trace received")
+            data += os.read(fd, 4096)
+            offset = find_trace(data)
+            if offset >= 0 and trace_size(data, offset) is not None:
+                return bytes(data)
+    finally:
+        os.close(fd)
+
+
+# ------------------------------------------------------------------------------
+# Analysis
+
+
+def assign_commands(records):
+    """Return the command that each record belongs to, or None."""
+    current = None
+    commands = []
+    for record in records:
+        if record.kind == TYPE_COMMAND and record.data:
+            current = record.data[0]
+        commands.append(current)
+    return commands
+
+
+def redundant_commands(records):
+    """
+    Return the indexes of the commands that set the same data as the previous
+    time they were sent, since the last reset or refresh. Only commands whose
+    data was completely stored in the trace are checked.
+    """
+    last = {}
+    redundant = []
+    i = 0
+    while i < len(records):
+        record = records[i]
+        i += 1
+        if record.kind != TYPE_COMMAND or not record.data:
+            continue
+
+        cmd = record.data[0]
+        index = i - 1
+        data = b""
+        complete = True
+        while i < len(records) and records[i].kind == TYPE_DATA:
+            data += records[i].data
+            complete = complete and records[i].length == len(records[i].data)
+            i += 1
+
+        if cmd in RESET_COMMANDS:
+            last.clear()
+            continue
+        if cmd in RAM_COMMANDS or not complete:
+            continue
+        if last.get(cmd) == data:
+            redundant.append(index)
+        last[cmd] = data
+    return redundant
+
+
+def print_timeline(records):
+    commands = assign_commands(records)
+    base = records[0].start
+    end = base
+
+    print("%10s %9s %9s  %-7s %6s  %s" %
+          ("time_ms", "gap_us", "dur_us", "type", "bytes", "content"))
+    for record, cmd in zip(records, commands):
+        gap = (record.start - end) & 0xFFFFFFFF
+        time_ms = ((record.start - base) & 0xFFFFFFFF) / 1000
+        if record.kind == TYPE_COMMAND:
+            kind = "command"
+            content = command_name(cmd) if cmd is not None else ""
+        elif record.kind == TYPE_DATA:
+            kind = "data"
+            content = record.data.hex(" ")
+            if record.length > len(record.data):
+                content += " ..."
+        else:
+            kind = "busy"
+            content = "after %s" % command_name(cmd) if cmd is not None else ""
+
+        print("%10.3f %9d %9d  %-7s %6d  %s" %
+              (time_ms, gap, record.duration, kind, record.length, content))
+        end = (record.start + record.duration) & 0xFFFFFFFF
+
+
+def print_summary(records, lost):
+    commands = assign_commands(records)
+    first = records[0].start
+    last = records[-1].start + records[-1].duration
+    total = (last - first) & 0xFFFFFFFF
+
+    spi = sum(r.duration for r in records if r.kind != TYPE_BUSY)
+    busy = sum(r.duration for r in records if r.kind == TYPE_BUSY)
+    idle = total - spi - busy
+
+    def share(value):
+        return 100 * value / total if total else 0
+
+    print("records:  %d (%d lost)" % (len(records), lost))
+    print("duration: %d us" % total)
+    print("spi:      %d us (%.1f%%), %d bytes" %
+          (spi, share(spi), sum(r.length for r in records
+                                if r.kind != TYPE_BUSY)))
+    print("busy:     %d us (%.1f%%)" % (busy, share(busy)))
+    print("idle:     %d us (%.1f%%)" % (idle, share(idle)))
+
+    # Time of each command, including its data and the BUSY waits after it
+    stats = {}
+    for record, cmd in zip(records, commands):
+        if cmd is None:
+            continue
+        entry = stats.setdefault(cmd, [0, 0, 0, 0])
+        if record.kind == TYPE_COMMAND:
+            entry[0] += 1
+        elif record.kind == TYPE_DATA:
+            entry[1] += record.length
+            entry[2] += record.duration
+        else:
+            entry[3] += record.duration
+
+    print()
+    print("%-28s %6s %8s %10s %10s" %
+          ("command", "count", "bytes", "spi_us", "busy_us"))
+    for cmd, (count, size, spi_us, busy_us) in \
+            sorted(stats.items(), key=lambda item: -(item[1][2] +
+                                                     item[1][3])):
+        print("%-28s %6d %8d %10d %10d" %
+              (command_name(cmd), count, size, spi_us, busy_us))
+
+    redundant = redundant_commands(records)
+    if redundant:
+        print()
+        print("redundant commands (same data since the last refresh):")
+        for index in redundant:
+            time_ms = ((records[index].start - first) & 0xFFFFFFFF) / 1000
+            print("  %10.3f ms  %s" %
+                  (time_ms, command_name(records[index].data[0])))
+
+
+# ------------------------------------------------------------------------------
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("input", nargs="?",
+                        help="file containing the trace")
+    parser.add_argument("--port",
+                        help="read the trace from a serial port instead")
+    parser.add_argument("--timeout", type=float, default=30.0,
+                        help="seconds to wait for data from the port")
+    parser.add_argument("--summary", action="store_true",
+                        help="only print the summary, not the timeline")
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.timeout)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        fail("specify an input file or '--port'")
+
+    records, lost = decode(data)
+    if not records:
+        print("the trace is empty")
+        return
+
+    if not args.summary:
+        print_timeline(records)
+        print()
+    print_summary(records, lost)
+
+
+if __name__ == "__main__":
+    main()